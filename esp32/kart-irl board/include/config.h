@@ -1,11 +1,113 @@
 #pragma once
 
+// Identité du kart (unique par châssis, surchargée en NVS)
+#define KART_ID 1
+
+// ESP-NOW kart-à-kart
+#define ESPNOW_MAX_PAYLOAD 16
+#define ESPNOW_SHARED_KEY "kart-irl"
+
 // WiFi
 #define WIFI_SSID "Freebox-604C8D"
 #define WIFI_PASSWORD "DeblocuS040991"
+#define WIFI_CONNECT_TIMEOUT_MS 15000
+// Power save coupé = latence d'entrée minimale (au prix de la conso)
+#define WIFI_DISABLE_POWER_SAVE 1
+// IP statique pour sauter le DHCP au boot (0 = DHCP)
+#define WIFI_USE_STATIC_IP 0
+#if WIFI_USE_STATIC_IP
+#define WIFI_STATIC_IP "192.168.1.50"
+#define WIFI_GATEWAY   "192.168.1.1"
+#define WIFI_SUBNET    "255.255.255.0"
+#endif
+
+// Répartition des tâches FreeRTOS :
+// coeur 0 = capture caméra + streaming HTTP, coeur 1 = contrôle/WebSocket/OTA/logs
+#define CORE_VIDEO 0
+#define CORE_CONTROL 1
+#define TASK_PRIO_CAPTURE 5
+#define TASK_STACK_CAPTURE 4096
+#define TASK_PRIO_STREAM 4
+#define TASK_STACK_STREAM 8192
+#define TASK_PRIO_CONTROL 3
+#define TASK_STACK_CONTROL 4096
+#define TASK_PRIO_LOG 1
+#define TASK_STACK_LOG 3072
+#define TASK_PRIO_DETECT 1
+#define TASK_STACK_DETECT 8192
+#define TASK_PRIO_TELEMETRY 1
+#define TASK_STACK_TELEMETRY 3072
+#define TASK_PRIO_OTA 1
+#define TASK_STACK_OTA 4096
+#define TASK_PRIO_FLIGHTREC 1
+#define TASK_STACK_FLIGHTREC 4096
+
+// Cadence de sonde de la socket OTA (hors mode course)
+#define OTA_POLL_PERIOD_MS 50
+
+// Télémétrie binaire périodique
+#define TELEMETRY_PERIOD_MS 500
+
+// Enregistreur de vol : anneau PSRAM, cadence d'échantillonnage des images
+#define FLIGHT_REC_SIZE (1024 * 1024)
+#define FLIGHT_REC_FRAME_PERIOD_MS 250
+
+// Bornes WebSocket : nombre de clients, entretien, éviction des clients
+// dont la file sortante reste pleine
+#define WS_MAX_CLIENTS 4
+#define WS_CLEANUP_PERIOD_MS 1000
+#define WS_EVICT_QUEUE_FULL 20
+
+// Pré-détection de marqueurs embarquée
+#define MARKER_DETECT_PERIOD_MS 100
+#define MARKER_THRESHOLD 60
+
+// Anneau de logs asynchrone
+#define LOG_RING_SLOTS 32
+#define LOG_SLOT_SIZE 128
+
+// Telnet : clients simultanés, tampon sortant par client
+#define LOG_TELNET_MAX_CLIENTS 3
+#define LOG_TELNET_BUF_SIZE 1024
+
+// Flux basse résolution pour la détection serveur : transcodage embarqué
+// (décodage 1/2 + ré-encodage), servi par une instance httpd dédiée
+#define STREAM_LOW_PORT 82
+#define STREAM_LOW_QUALITY 25
+#define TASK_PRIO_STREAMLOW 2
+#define TASK_STACK_STREAMLOW 8192
+
+// Streaming adaptatif : budget de latence d'envoi par image et hystérésis
+#define STREAM_LAT_BUDGET_US 70000
+#define STREAM_STEP_DOWN_MS 250
+#define STREAM_STEP_UP_MS 3000
+
+// Contrôle UDP (datagrammes de pilotage séquencés)
+#define UDP_CONTROL_PORT 8266
+
+// Stream vidéo UDP (images JPEG fragmentées, perte = image jetée)
+#define UDP_STREAM_PORT 8267
+#define UDP_STREAM_MTU 1400
+#define UDP_STREAM_HELLO_TIMEOUT_MS 5000
+#define TASK_PRIO_UDPSTREAM 3
+#define TASK_STACK_UDPSTREAM 4096
+
+// Rampe moteur : pas (en unités de vitesse -255..255) par période de timer.
+// La décélération vers zéro est plus rapide que l'accélération.
+#define ENGINE_RAMP_PERIOD_MS 10
+#define ENGINE_RAMP_ACCEL 12
+#define ENGINE_RAMP_DECEL 30
+
+// Failsafe homme-mort : arrêt moteur après ce silence de contrôle
+#define FAILSAFE_TIMEOUT_MS 250
+#define SERVO_CENTER_ANGLE 90
 
 #define LED_FLASH 4
 #define SERVO_PIN 2
+#define PWM_CHANNEL_SERVO 4
+// Butées mécaniques de la tringlerie, en µs d'impulsion
+#define SERVO_PULSE_MIN_US 1000
+#define SERVO_PULSE_MAX_US 2000
 
 // PIN ENGINE
 #define PIN_ENGINE_PWM 14
@@ -2,9 +2,14 @@
 
 #include <esp_camera.h>
 #include <esp_http_server.h>
+#include <img_converters.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
 #include <Arduino.h>
 
+#include "config.h"
 #include "log.h"
+#include "metrics.h"
 
 // AI Thinker ESP32-CAM pin definitions
 #define CAM_PIN_PWDN     32
@@ -26,38 +31,383 @@
 
 #define STREAM_CONTENT_TYPE "multipart/x-mixed-replace;boundary=frame"
 #define STREAM_BOUNDARY "\r\n--frame\r\n"
-#define STREAM_PART "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n"
+// X-Timestamp (µs, horloge esp_timer), X-Sequence et X-Capture-Us rendent
+// le pipeline mesurable : le serveur peut calculer la latence de bout en
+// bout par image et repérer les images perdues. Un seul snprintf par image.
+#define STREAM_PART \
+  "Content-Type: image/jpeg\r\nContent-Length: %u\r\n" \
+  "X-Timestamp: %lld\r\nX-Sequence: %lu\r\nX-Capture-Us: %lu\r\n\r\n"
 
-static esp_err_t streamHandler(httpd_req_t *req) {
-  camera_fb_t *fb = NULL;
-  esp_err_t res = ESP_OK;
-  char partBuf[64];
+// --- Capture partagée ---
+//
+// Une seule tâche appelle esp_camera_fb_get() et publie chaque image dans
+// un des emplacements PSRAM ci-dessous. Les clients de stream lisent
+// le dernier emplacement publié via cameraFrameAcquire() : N spectateurs
+// coûtent une seule capture, et un client lent saute naturellement à la
+// dernière image au lieu de freiner les autres.
+//
+// Trois emplacements minimum : un lecteur lent peut retenir le sien
+// pendant tout un writev bloquant, un autre est le dernier publié, et il
+// faut encore un emplacement libre pour que la capture continue de
+// publier — avec deux, un seul client TCP calé gelait tous les
+// consommateurs (deuxième spectateur, UDP, détection, enregistreur).
+
+#define FRAME_SLOTS 3
+
+typedef struct {
+  uint8_t *data;
+  size_t capacity;
+  size_t len;
+  uint32_t seq;
+  int64_t timestampUs;
+  uint32_t captureUs;
+  int readers;
+} FrameSlot;
 
-  res = httpd_resp_set_type(req, STREAM_CONTENT_TYPE);
-  if (res != ESP_OK) return res;
+static FrameSlot slots[FRAME_SLOTS];
+static int latestSlot = -1;
+static uint32_t frameSeq = 0;
+static SemaphoreHandle_t frameMutex;
+
+static volatile uint32_t statCaptured = 0;
+static volatile uint32_t statSent = 0;
+static volatile uint32_t statDropped = 0;
+
+void cameraGetStats(uint32_t *captured, uint32_t *sent, uint32_t *dropped) {
+  *captured = statCaptured;
+  *sent = statSent;
+  *dropped = statDropped;
+}
 
+static volatile bool streamPaused = false;
+
+void cameraStreamPause(bool paused) {
+  streamPaused = paused;
+}
+
+static void captureTask(void *arg) {
   while (true) {
-    fb = esp_camera_fb_get();
+    if (streamPaused) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+    int64_t captureStart = esp_timer_get_time();
+    uint32_t mc = metricsBegin();
+    camera_fb_t *fb = esp_camera_fb_get();
+    metricsEnd(METRIC_CAPTURE, mc);
     if (!fb) {
       logPrintln("Camera: capture failed");
-      res = ESP_FAIL;
-      break;
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
     }
+    statCaptured++;
 
-    size_t hlen = snprintf(partBuf, sizeof(partBuf), STREAM_PART, fb->len);
+    // Choisit un emplacement libre qui n'est pas le dernier publié.
+    // Seule cette tâche change latestSlot et les lecteurs ne verrouillent
+    // que le dernier publié : la copie peut donc se faire hors mutex.
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    int target = -1;
+    for (int i = 0; i < FRAME_SLOTS; i++) {
+      if (i != latestSlot && slots[i].readers == 0) {
+        target = i;
+        break;
+      }
+    }
+    xSemaphoreGive(frameMutex);
+
+    if (target >= 0) {
+      FrameSlot *slot = &slots[target];
+      if (slot->capacity < fb->len) {
+        slot->data = (uint8_t *)heap_caps_realloc(slot->data, fb->len, MALLOC_CAP_SPIRAM);
+        slot->capacity = slot->data ? fb->len : 0;
+      }
+      if (slot->data) {
+        memcpy(slot->data, fb->buf, fb->len);
+        slot->len = fb->len;
+        slot->timestampUs = esp_timer_get_time();
+        slot->captureUs = (uint32_t)(slot->timestampUs - captureStart);
 
-    res = httpd_resp_send_chunk(req, STREAM_BOUNDARY, strlen(STREAM_BOUNDARY));
-    if (res == ESP_OK)
-      res = httpd_resp_send_chunk(req, partBuf, hlen);
-    if (res == ESP_OK)
-      res = httpd_resp_send_chunk(req, (const char *)fb->buf, fb->len);
+        xSemaphoreTake(frameMutex, portMAX_DELAY);
+        slot->seq = ++frameSeq;
+        latestSlot = target;
+        xSemaphoreGive(frameMutex);
+      }
+    }
+    // target < 0 : les deux emplacements sont en lecture, l'image est jetée.
+    if (target < 0) statDropped++;
 
     esp_camera_fb_return(fb);
+  }
+}
+
+bool cameraFrameAcquire(CameraFrame *frame, uint32_t lastSeq, uint32_t timeoutMs) {
+  int64_t deadline = esp_timer_get_time() + (int64_t)timeoutMs * 1000;
+  while (true) {
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    if (latestSlot >= 0 && slots[latestSlot].seq != lastSeq) {
+      FrameSlot *slot = &slots[latestSlot];
+      slot->readers++;
+      frame->data = slot->data;
+      frame->len = slot->len;
+      frame->seq = slot->seq;
+      frame->timestampUs = slot->timestampUs;
+      frame->captureUs = slot->captureUs;
+      xSemaphoreGive(frameMutex);
+      return true;
+    }
+    xSemaphoreGive(frameMutex);
+
+    if (esp_timer_get_time() >= deadline) return false;
+    vTaskDelay(pdMS_TO_TICKS(2));
+  }
+}
+
+void cameraFrameRelease(const CameraFrame *frame) {
+  xSemaphoreTake(frameMutex, portMAX_DELAY);
+  for (int i = 0; i < FRAME_SLOTS; i++) {
+    if (slots[i].data == frame->data) {
+      slots[i].readers--;
+      break;
+    }
+  }
+  xSemaphoreGive(frameMutex);
+}
+
+// --- Streaming adaptatif ---
+//
+// Quand le WiFi se dégrade, l'envoi TCP bloque et la latence image explose.
+// On mesure la durée d'envoi de chaque image et on descend l'échelle
+// qualité/résolution sous congestion, puis on remonte quand le canal
+// redevient sain. 15 FPS en QVGA valent mieux qu'une VGA figée.
+
+typedef struct {
+  framesize_t framesize;
+  int quality;  // 0-63, plus grand = plus compressé
+} StreamLevel;
+
+static const StreamLevel streamLevels[] = {
+  { FRAMESIZE_VGA,  12 },
+  { FRAMESIZE_VGA,  18 },
+  { FRAMESIZE_QVGA, 14 },
+  { FRAMESIZE_QVGA, 20 },
+};
+#define STREAM_LEVEL_COUNT (sizeof(streamLevels) / sizeof(streamLevels[0]))
+
+static int streamLevel = 0;
+static int64_t sendEwmaUs = 0;
+static int64_t lastLevelChangeUs = 0;
+static int64_t lastCongestionUs = 0;
+
+static void applyStreamLevel(int level) {
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s) return;
+  s->set_framesize(s, streamLevels[level].framesize);
+  s->set_quality(s, streamLevels[level].quality);
+  streamLevel = level;
+  lastLevelChangeUs = esp_timer_get_time();
+  logPrintf("Stream: niveau %d (framesize %d, qualite %d)", level,
+            streamLevels[level].framesize, streamLevels[level].quality);
+}
+
+// Appelé après chaque envoi d'image avec sa durée mesurée.
+static void adaptiveReportSend(int64_t sendUs) {
+  // EWMA 1/4 : réagit en quelques images sans s'affoler sur un pic isolé.
+  sendEwmaUs += (sendUs - sendEwmaUs) / 4;
+
+  int64_t now = esp_timer_get_time();
+  if (sendEwmaUs > STREAM_LAT_BUDGET_US) {
+    lastCongestionUs = now;
+    if (streamLevel < (int)STREAM_LEVEL_COUNT - 1 &&
+        now - lastLevelChangeUs > (int64_t)STREAM_STEP_DOWN_MS * 1000) {
+      applyStreamLevel(streamLevel + 1);
+    }
+  } else if (streamLevel > 0 &&
+             now - lastCongestionUs > (int64_t)STREAM_STEP_UP_MS * 1000 &&
+             now - lastLevelChangeUs > (int64_t)STREAM_STEP_UP_MS * 1000) {
+    applyStreamLevel(streamLevel - 1);
+  }
+}
+
+// --- Stream HTTP ---
+
+// Envoie en-tête de part + corps JPEG en un seul writev sur la socket :
+// pas de chunked encoding, pas de copie du framebuffer par la couche httpd,
+// et un seul segment TCP de départ au lieu de trois.
+static bool sendFrameVec(int fd, const char *hdr, size_t hlen,
+                         const uint8_t *body, size_t blen) {
+  struct iovec iov[2] = {
+    { (void *)hdr, hlen },
+    { (void *)body, blen },
+  };
+  size_t total = hlen + blen;
+  size_t done = 0;
+
+  while (done < total) {
+    // Réajuste les iovec après une écriture partielle.
+    struct iovec cur[2];
+    int n = 0;
+    size_t skip = done;
+    for (int i = 0; i < 2; i++) {
+      if (skip >= iov[i].iov_len) {
+        skip -= iov[i].iov_len;
+        continue;
+      }
+      cur[n].iov_base = (uint8_t *)iov[i].iov_base + skip;
+      cur[n].iov_len = iov[i].iov_len - skip;
+      skip = 0;
+      n++;
+    }
+    ssize_t sent = writev(fd, cur, n);
+    if (sent <= 0) return false;
+    done += sent;
+  }
+  return true;
+}
+
+static esp_err_t streamHandler(httpd_req_t *req) {
+  char partBuf[192];
+  CameraFrame frame;
+  uint32_t lastSeq = 0;
 
-    if (res != ESP_OK) break;
+  int fd = httpd_req_to_sockfd(req);
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  // Réponse HTTP écrite à la main une seule fois, le reste du flux passe
+  // en direct sur la socket.
+  static const char respHeader[] =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: " STREAM_CONTENT_TYPE "\r\n"
+      "Connection: close\r\n"
+      "\r\n";
+  if (httpd_send(req, respHeader, sizeof(respHeader) - 1) < 0) return ESP_FAIL;
+
+  while (true) {
+    if (!cameraFrameAcquire(&frame, lastSeq, 1000)) continue;
+    lastSeq = frame.seq;
+
+    size_t hlen = snprintf(partBuf, sizeof(partBuf),
+                           STREAM_BOUNDARY STREAM_PART, frame.len,
+                           (long long)frame.timestampUs,
+                           (unsigned long)frame.seq,
+                           (unsigned long)frame.captureUs);
+
+    int64_t sendStart = esp_timer_get_time();
+    uint32_t mc = metricsBegin();
+    bool ok = sendFrameVec(fd, partBuf, hlen, frame.data, frame.len);
+    metricsEnd(METRIC_FRAME_SEND, mc);
+
+    cameraFrameRelease(&frame);
+
+    if (!ok) break;
+    statSent++;
+    adaptiveReportSend(esp_timer_get_time() - sendStart);
   }
 
-  return res;
+  // La réponse a été écrite en direct : on rend ESP_FAIL pour que httpd
+  // ferme la socket sans rien y ajouter.
+  return ESP_FAIL;
+}
+
+// --- Flux basse résolution ---
+//
+// La détection serveur n'a besoin que d'environ QVGA alors que les
+// spectateurs regardent la VGA native : transcoder à bord (décodage au 1/2
+// puis ré-encodage JPEG) divise par ~4 les octets du flux détection, donc
+// la charge de l'AP et du thread d'ingestion serveur par kart. Un handler
+// MJPEG bloquant monopolise sa tâche httpd : le flux bas vit dans sa propre
+// instance sur STREAM_LOW_PORT, épinglée sur le coeur contrôle pour ne rien
+// prendre au pipeline capture/envoi du coeur vidéo. Sans client connecté,
+// le transcodage ne tourne pas.
+
+static uint8_t *lowRgbBuf;    // RGB565 décodé au 1/2, PSRAM (taille VGA/2)
+static uint8_t *lowJpegBuf;   // copie du JPEG source, PSRAM
+static size_t lowJpegCap = 0;
+
+// Dimensions de l'image décodée au 1/2 selon la résolution courante.
+static bool lowDims(int *w, int *h) {
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s) return false;
+  switch (s->status.framesize) {
+    case FRAMESIZE_VGA:  *w = 320; *h = 240; return true;
+    case FRAMESIZE_QVGA: *w = 160; *h = 120; return true;
+    default: return false;
+  }
+}
+
+static esp_err_t streamLowHandler(httpd_req_t *req) {
+  char partBuf[192];
+  CameraFrame frame;
+  uint32_t lastSeq = 0;
+
+  if (!lowRgbBuf) {
+    lowRgbBuf = (uint8_t *)heap_caps_malloc(320 * 240 * 2, MALLOC_CAP_SPIRAM);
+  }
+  if (!lowRgbBuf) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "no psram");
+    return ESP_FAIL;
+  }
+
+  int fd = httpd_req_to_sockfd(req);
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  static const char respHeader[] =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: " STREAM_CONTENT_TYPE "\r\n"
+      "Connection: close\r\n"
+      "\r\n";
+  if (httpd_send(req, respHeader, sizeof(respHeader) - 1) < 0) return ESP_FAIL;
+
+  while (true) {
+    int w, h;
+    if (!lowDims(&w, &h)) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+    if (!cameraFrameAcquire(&frame, lastSeq, 1000)) continue;
+    lastSeq = frame.seq;
+
+    // Copie du JPEG source puis libération immédiate : le transcodage dure
+    // des dizaines de ms, trop long pour retenir un emplacement partagé
+    // sans faire jeter des captures.
+    if (lowJpegCap < frame.len) {
+      lowJpegBuf = (uint8_t *)heap_caps_realloc(lowJpegBuf, frame.len, MALLOC_CAP_SPIRAM);
+      lowJpegCap = lowJpegBuf ? frame.len : 0;
+    }
+    if (!lowJpegBuf) {
+      cameraFrameRelease(&frame);
+      break;
+    }
+    memcpy(lowJpegBuf, frame.data, frame.len);
+    size_t srcLen = frame.len;
+    int64_t srcTimestampUs = frame.timestampUs;
+    uint32_t srcSeq = frame.seq;
+    uint32_t srcCaptureUs = frame.captureUs;
+    cameraFrameRelease(&frame);
+
+    if (!jpg2rgb565(lowJpegBuf, srcLen, lowRgbBuf, JPG_SCALE_2X)) continue;
+
+    uint8_t *jpg = NULL;
+    size_t jpgLen = 0;
+    if (!fmt2jpg(lowRgbBuf, w * h * 2, w, h, PIXFORMAT_RGB565,
+                 STREAM_LOW_QUALITY, &jpg, &jpgLen)) {
+      continue;
+    }
+
+    // Mêmes en-têtes de mesure que le flux natif : la séquence et
+    // l'horodatage sont ceux de l'image source, pas du transcodage.
+    size_t hlen = snprintf(partBuf, sizeof(partBuf),
+                           STREAM_BOUNDARY STREAM_PART, (unsigned)jpgLen,
+                           (long long)srcTimestampUs,
+                           (unsigned long)srcSeq,
+                           (unsigned long)srcCaptureUs);
+    bool ok = sendFrameVec(fd, partBuf, hlen, jpg, jpgLen);
+    free(jpg);
+    if (!ok) break;
+  }
+
+  return ESP_FAIL;
 }
 
 void cameraSetup() {
@@ -98,8 +448,17 @@ void cameraSetup() {
 }
 
 void cameraStreamSetup() {
+  frameMutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(captureTask, "capture", TASK_STACK_CAPTURE, NULL,
+                          TASK_PRIO_CAPTURE, NULL, CORE_VIDEO);
+
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.server_port = 81;
+  // Le serveur de stream vit sur le coeur vidéo pour ne pas disputer
+  // le coeur contrôle aux callbacks WebSocket.
+  config.core_id = CORE_VIDEO;
+  config.task_priority = TASK_PRIO_STREAM;
+  config.stack_size = TASK_STACK_STREAM;
 
   httpd_handle_t streamServer = NULL;
   if (httpd_start(&streamServer, &config) == ESP_OK) {
@@ -114,4 +473,26 @@ void cameraStreamSetup() {
   } else {
     logPrintln("Camera stream server failed to start");
   }
+
+  httpd_config_t lowConfig = HTTPD_DEFAULT_CONFIG();
+  lowConfig.server_port = STREAM_LOW_PORT;
+  // Chaque instance httpd a besoin de son propre port de contrôle interne.
+  lowConfig.ctrl_port = 32769;
+  lowConfig.core_id = CORE_CONTROL;
+  lowConfig.task_priority = TASK_PRIO_STREAMLOW;
+  lowConfig.stack_size = TASK_STACK_STREAMLOW;
+
+  httpd_handle_t lowServer = NULL;
+  if (httpd_start(&lowServer, &lowConfig) == ESP_OK) {
+    httpd_uri_t streamLowUri = {
+      .uri       = "/stream-low",
+      .method    = HTTP_GET,
+      .handler   = streamLowHandler,
+      .user_ctx  = NULL
+    };
+    httpd_register_uri_handler(lowServer, &streamLowUri);
+    logPrintf("Flux basse resolution demarre sur le port %d", STREAM_LOW_PORT);
+  } else {
+    logPrintln("Flux basse resolution: demarrage impossible");
+  }
 }
@@ -1,4 +1,28 @@
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+
+// Image JPEG publiée par la tâche de capture partagée.
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+  uint32_t seq;
+  int64_t timestampUs;
+  uint32_t captureUs;  // durée de la capture elle-même
+} CameraFrame;
+
 void cameraSetup();
 void cameraStreamSetup();
+
+// Suspend/reprend la capture (utilisé pendant une mise à jour OTA pour
+// laisser le bus aux écritures flash).
+void cameraStreamPause(bool paused);
+
+// Attend une image plus récente que lastSeq (au plus timeoutMs) et la
+// verrouille en lecture. Retourne false si le délai expire.
+bool cameraFrameAcquire(CameraFrame *frame, uint32_t lastSeq, uint32_t timeoutMs);
+void cameraFrameRelease(const CameraFrame *frame);
+
+// Compteurs de télémétrie (capturées / envoyées au stream / jetées).
+void cameraGetStats(uint32_t *captured, uint32_t *sent, uint32_t *dropped);
@@ -0,0 +1,90 @@
+#include "config_store.h"
+
+#include <Preferences.h>
+
+#include "config.h"
+#include "log.h"
+
+static Preferences prefs;
+
+// Cache des paramètres appliqués à chaud : lus par des contextes où une
+// lecture NVS (flash) n'a pas sa place, comme le callback du failsafe.
+static int servoCenter = SERVO_CENTER_ANGLE;
+
+static void applyLive(const char *key) {
+  if (strcmp(key, "servo_center") == 0) {
+    servoCenter = prefs.getInt(key, SERVO_CENTER_ANGLE);
+    logPrintf("Config: servo_center applique a %d", servoCenter);
+  }
+  // Les autres clés (wifi, ports...) sont relues au prochain boot.
+}
+
+void configStoreSetup() {
+  prefs.begin("kart", false);
+  servoCenter = prefs.getInt("servo_center", SERVO_CENTER_ANGLE);
+  logPrintln("Config NVS chargée");
+}
+
+int configGetInt(const char *key, int def) {
+  return prefs.getInt(key, def);
+}
+
+bool configSetInt(const char *key, int value) {
+  if (prefs.putInt(key, value) == 0) return false;
+  applyLive(key);
+  return true;
+}
+
+String configGetString(const char *key, const char *def) {
+  return prefs.getString(key, def);
+}
+
+bool configSetString(const char *key, const char *value) {
+  if (prefs.putString(key, value) == 0) return false;
+  applyLive(key);
+  return true;
+}
+
+int configServoCenter() {
+  return servoCenter;
+}
+
+bool configHandleMessage(JsonDocument &doc, String &reply) {
+  const char *op = doc["op"];
+  const char *key = doc["key"];
+  if (!op || !key) return false;
+
+  JsonDocument out;
+  out["type"] = "config";
+  out["key"] = key;
+
+  if (strcmp(op, "set") == 0) {
+    JsonVariant value = doc["value"];
+    bool ok;
+    if (value.is<const char *>()) {
+      ok = configSetString(key, value.as<const char *>());
+    } else if (value.is<int>()) {
+      ok = configSetInt(key, value.as<int>());
+    } else {
+      return false;
+    }
+    out["ok"] = ok;
+  } else if (strcmp(op, "get") == 0) {
+    switch (prefs.getType(key)) {
+      case PT_I32:
+        out["value"] = prefs.getInt(key, 0);
+        break;
+      case PT_STR:
+        out["value"] = prefs.getString(key, "");
+        break;
+      default:
+        out["value"] = nullptr;  // absent : le défaut compilé s'applique
+        break;
+    }
+  } else {
+    return false;
+  }
+
+  serializeJson(out, reply);
+  return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Configuration persistée en NVS, avec les valeurs de include/config.h en
+// défauts de compilation. Permet de régler un kart en course sans
+// recompiler ni reflasher : message WebSocket {"type":"config", ...}.
+
+void configStoreSetup();
+
+// Lectures/écritures typées (lecture NVS directe : usage au setup, pas
+// sur un chemin chaud).
+int configGetInt(const char *key, int def);
+bool configSetInt(const char *key, int value);
+String configGetString(const char *key, const char *def);
+bool configSetString(const char *key, const char *value);
+
+// Valeurs à application immédiate, mises en cache pour les chemins chauds.
+int configServoCenter();
+
+// Traite un message {"type":"config","op":"get"|"set","key":...,"value":...}
+// et construit la réponse JSON. Retourne false si le message est invalide.
+bool configHandleMessage(JsonDocument &doc, String &reply);
@@ -1,10 +1,31 @@
 #include "engine.h"
 
+#include <array>
+
+#include <esp_timer.h>
+
+#include "config.h"
+#include "flight_recorder.h"
 #include "log.h"
+#include "metrics.h"
 
 static const int PWM_FREQ = 5000;
 static const int PWM_RESOLUTION = 8; // 0-255
 
+// Courbe de réponse générée à la compilation : mélange linéaire/quadratique
+// qui adoucit le bas de course (contrôle fin) sans perdre le haut.
+// Remplace le mapping linéaire -255..255 ; que des entiers sur le chemin chaud.
+static constexpr std::array<uint8_t, 256> makeThrottleCurve() {
+  std::array<uint8_t, 256> curve{};
+  for (int i = 0; i < 256; i++) {
+    int lin = i;
+    int quad = (i * i) / 255;
+    curve[i] = (uint8_t)((lin + quad) / 2);
+  }
+  return curve;
+}
+static constexpr auto throttleCurve = makeThrottleCurve();
+
 Motor::Motor(int pwmPin, int in1Pin, int in2Pin, int channel)
   : _pwmPin(pwmPin), _in1Pin(in1Pin), _in2Pin(in2Pin), _channel(channel) {}
 
@@ -17,8 +38,38 @@ void Motor::setup() {
 }
 
 void Motor::setSpeed(int speed) {
+  uint32_t mc = metricsBegin();
   if (speed < -255) speed = -255;
   if (speed > 255) speed = 255;
+  // O(1) : on ne fait que poser la cible, les écritures PWM se font
+  // dans rampStep() hors de la tâche réseau.
+  _target = speed;
+  metricsEnd(METRIC_MOTOR_SET, mc);
+}
+
+void Motor::rampStep() {
+  int targetQ8 = _target << 8;
+  int cur = _currentQ8;
+  if (cur == targetQ8) return;
+
+  // Freiner (revenir vers zéro) est permis plus vite qu'accélérer :
+  // c'est l'à-coup pleine marche arrière -> pleine marche avant qui
+  // écroule le rail 5 V, pas la décélération.
+  bool towardZero = (cur > 0 && targetQ8 < cur) || (cur < 0 && targetQ8 > cur);
+  int step = (towardZero ? ENGINE_RAMP_DECEL : ENGINE_RAMP_ACCEL) << 8;
+
+  if (targetQ8 > cur) {
+    cur += step;
+    if (cur > targetQ8) cur = targetQ8;
+  } else {
+    cur -= step;
+    if (cur < targetQ8) cur = targetQ8;
+  }
+  _currentQ8 = cur;
+  applyRaw(cur >> 8);
+}
+
+void Motor::applyRaw(int speed) {
   if (speed > 0) {
     digitalWrite(_in1Pin, HIGH);
     digitalWrite(_in2Pin, LOW);
@@ -29,26 +80,42 @@ void Motor::setSpeed(int speed) {
     digitalWrite(_in1Pin, LOW);
     digitalWrite(_in2Pin, LOW);
   }
-  ledcWrite(_channel, abs(speed));
+  ledcWrite(_channel, throttleCurve[abs(speed)]);
 }
 
 void Motor::stop() {
-  setSpeed(0);
+  _target = 0;
+  _currentQ8 = 0;
+  applyRaw(0);
 }
 
 // --- API globale ---
 
 static Motor *_motor;
+static esp_timer_handle_t rampTimer;
+
+static void onRampTick(void *arg) {
+  _motor->rampStep();
+}
 
 void engineSetup(Motor &motor) {
   _motor = &motor;
   _motor->setup();
-  logPrintln("Moteur initialisé (TB6612FNG)");
+
+  esp_timer_create_args_t args = {};
+  args.callback = onRampTick;
+  args.name = "engine_ramp";
+  esp_timer_create(&args, &rampTimer);
+  esp_timer_start_periodic(rampTimer, (uint64_t)ENGINE_RAMP_PERIOD_MS * 1000);
+
+  logPrintln("Moteur initialisé (TB6612FNG, rampe " + String(ENGINE_RAMP_PERIOD_MS) + " ms)");
 }
 
 void engineSetSpeed(int speed) {
   _motor->setSpeed(speed);
-  logPrintln("Moteur vitesse " + String(speed));
+  int16_t rec = (int16_t)speed;
+  flightRecEvent(FREC_MOTOR, (const uint8_t *)&rec, sizeof(rec));
+  logPrintf("Moteur vitesse %d", speed);
 }
 
 void engineStop() {
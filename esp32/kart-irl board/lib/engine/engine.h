@@ -7,14 +7,22 @@ public:
   Motor(int pwmPin, int in1Pin, int in2Pin, int channel);
   void setup();
   // speed: -255 (full reverse) to 255 (full forward)
+  // Mémorise la cible ; la rampe (esp_timer périodique) fait le reste.
   void setSpeed(int speed);
+  // Coupe immédiatement, sans rampe (utilisé par le failsafe).
   void stop();
+  // Un pas de rampe, appelé depuis le timer périodique.
+  void rampStep();
 
 private:
+  void applyRaw(int speed);
+
   int _pwmPin;
   int _in1Pin;
   int _in2Pin;
   int _channel;
+  volatile int _target = 0;
+  int _currentQ8 = 0;  // vitesse appliquée, virgule fixe Q8
 };
 
 void engineSetup(Motor &motor);
@@ -0,0 +1,97 @@
+#include "espnow_link.h"
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+
+#include "config.h"
+#include "web_server.h"
+#include "log.h"
+
+// Trame : [magic][type][kartId][seq][len][payload...][somme clé 4 octets].
+// La diffusion ESP-NOW ne peut pas être chiffrée par pair, donc les trames
+// sont authentifiées par une somme FNV-1a calculée sur la clé partagée
+// puis la trame — assez pour écarter le trafic parasite sur le canal.
+
+#define ESPNOW_MAGIC 0x4B  // 'K'
+#define ESPNOW_HEADER_SIZE 5
+#define ESPNOW_SUM_SIZE 4
+
+// Opcode WebSocket encapsulant un événement inter-kart relayé au serveur.
+#define ESPNOW_WS_OPCODE 0xC0
+
+static const uint8_t broadcastAddr[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static uint8_t sendSeq = 0;
+static bool ready = false;
+
+static uint32_t frameSum(const uint8_t *frame, size_t len) {
+  uint32_t hash = 2166136261u;
+  const char *key = ESPNOW_SHARED_KEY;
+  for (const char *k = key; *k; k++) hash = (hash ^ (uint8_t)*k) * 16777619u;
+  for (size_t i = 0; i < len; i++) hash = (hash ^ frame[i]) * 16777619u;
+  return hash;
+}
+
+static void onReceive(const uint8_t *mac, const uint8_t *data, int len) {
+  // Bornes avant tout : une trame ESP-NOW peut porter jusqu'à 250 octets,
+  // le tampon de relai ci-dessous n'en tient que 1 + 5 + ESPNOW_MAX_PAYLOAD.
+  if (len < ESPNOW_HEADER_SIZE + ESPNOW_SUM_SIZE ||
+      len > ESPNOW_HEADER_SIZE + ESPNOW_MAX_PAYLOAD + ESPNOW_SUM_SIZE) return;
+  if (data[0] != ESPNOW_MAGIC) return;
+  if (data[2] == KART_ID) return;  // notre propre diffusion
+
+  size_t bodyLen = len - ESPNOW_SUM_SIZE;
+  // La longueur déclarée doit correspondre à la longueur reçue.
+  if (data[4] != bodyLen - ESPNOW_HEADER_SIZE) return;
+  uint32_t sum = (uint32_t)data[bodyLen] | ((uint32_t)data[bodyLen + 1] << 8) |
+                 ((uint32_t)data[bodyLen + 2] << 16) | ((uint32_t)data[bodyLen + 3] << 24);
+  if (frameSum(data, bodyLen) != sum) return;
+
+  // Relai au serveur : trame encapsulée telle quelle derrière l'opcode WS.
+  uint8_t event[1 + ESPNOW_HEADER_SIZE + ESPNOW_MAX_PAYLOAD];
+  event[0] = ESPNOW_WS_OPCODE;
+  memcpy(event + 1, data, bodyLen);
+  webServerSendEvent(event, 1 + bodyLen);
+}
+
+bool espnowSendEvent(uint8_t eventType, const uint8_t *payload, size_t len) {
+  if (!ready || len > ESPNOW_MAX_PAYLOAD) return false;
+
+  uint8_t frame[ESPNOW_HEADER_SIZE + ESPNOW_MAX_PAYLOAD + ESPNOW_SUM_SIZE];
+  frame[0] = ESPNOW_MAGIC;
+  frame[1] = eventType;
+  frame[2] = KART_ID;
+  frame[3] = sendSeq++;
+  frame[4] = (uint8_t)len;
+  if (len > 0) memcpy(frame + ESPNOW_HEADER_SIZE, payload, len);
+
+  size_t bodyLen = ESPNOW_HEADER_SIZE + len;
+  uint32_t sum = frameSum(frame, bodyLen);
+  frame[bodyLen] = sum & 0xFF;
+  frame[bodyLen + 1] = (sum >> 8) & 0xFF;
+  frame[bodyLen + 2] = (sum >> 16) & 0xFF;
+  frame[bodyLen + 3] = (sum >> 24) & 0xFF;
+
+  return esp_now_send(broadcastAddr, frame, bodyLen + ESPNOW_SUM_SIZE) == ESP_OK;
+}
+
+void espnowLinkSetup() {
+  if (esp_now_init() != ESP_OK) {
+    logPrintln("ESP-NOW: init impossible");
+    return;
+  }
+
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, broadcastAddr, 6);
+  peer.ifidx = WIFI_IF_STA;  // même canal que l'association station
+  peer.channel = 0;
+  peer.encrypt = false;
+  if (esp_now_add_peer(&peer) != ESP_OK) {
+    logPrintln("ESP-NOW: ajout du pair broadcast impossible");
+    return;
+  }
+
+  esp_now_register_recv_cb(onReceive);
+  ready = true;
+  logPrintln("ESP-NOW prêt (kart " + String(KART_ID) + ")");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Canal ESP-NOW kart-à-kart : événements de jeu en direct entre karts
+// (sub-10 ms), sans passer par AP + serveur. Le serveur reste autoritaire
+// et reçoit les mêmes événements via le WebSocket.
+
+void espnowLinkSetup();
+
+// Diffuse un événement signé aux autres karts. payload limité à
+// ESPNOW_MAX_PAYLOAD octets.
+bool espnowSendEvent(uint8_t eventType, const uint8_t *payload, size_t len);
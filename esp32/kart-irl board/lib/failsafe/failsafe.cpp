@@ -0,0 +1,38 @@
+#include "failsafe.h"
+
+#include <esp_timer.h>
+
+#include "config.h"
+#include "config_store.h"
+#include "engine.h"
+#include "servo_controller.h"
+#include "log.h"
+
+// Homme-mort : si aucune commande de pilotage n'arrive pendant
+// FAILSAFE_TIMEOUT_MS, le moteur est coupé et la direction recentrée
+// depuis le contexte esp_timer — indépendant de la loop Arduino et de la
+// pile WebSocket, donc le kart s'arrête même si AsyncTCP est bloqué.
+
+static esp_timer_handle_t deadline;
+
+static void onDeadline(void *arg) {
+  engineStop();
+  servoSetAngle(configServoCenter());
+  logPrintln("Failsafe: silence de contrôle, moteur coupé");
+}
+
+void failsafeSetup() {
+  esp_timer_create_args_t args = {};
+  args.callback = onDeadline;
+  args.name = "failsafe";
+  esp_timer_create(&args, &deadline);
+  // Armé dès le boot : tant qu'aucune commande n'arrive, le kart reste à l'arrêt.
+  esp_timer_start_once(deadline, (uint64_t)FAILSAFE_TIMEOUT_MS * 1000);
+  logPrintln("Failsafe armé (" + String(FAILSAFE_TIMEOUT_MS) + " ms)");
+}
+
+void failsafeFeed() {
+  if (!deadline) return;
+  esp_timer_stop(deadline);
+  esp_timer_start_once(deadline, (uint64_t)FAILSAFE_TIMEOUT_MS * 1000);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+void failsafeSetup();
+
+// À appeler à chaque commande de pilotage acceptée : réarme l'échéance.
+void failsafeFeed();
@@ -0,0 +1,131 @@
+#include "flight_recorder.h"
+
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+#include <Arduino.h>
+
+#include "config.h"
+#include "camera.h"
+#include "log.h"
+
+#define FREC_MAGIC 0x5A
+
+// En-tête d'enregistrement tel qu'il apparaît dans l'anneau et le dump.
+typedef struct __attribute__((packed)) {
+  uint8_t magic;
+  uint8_t type;
+  uint16_t len;
+  int64_t timestampUs;
+} FrecHeader;
+
+static uint8_t *ring;          // anneau d'octets, PSRAM
+static size_t ringCap = 0;
+static size_t head = 0;        // prochaine écriture (offset modulaire)
+static size_t tail = 0;        // plus ancien enregistrement intact
+static size_t used = 0;        // octets occupés entre tail et head
+static volatile bool frozen = false;
+static SemaphoreHandle_t recMutex;
+
+// memcpy modulaire vers/depuis l'anneau (un enregistrement peut enjamber
+// la fin du tampon).
+static void ringWrite(size_t pos, const uint8_t *src, size_t len) {
+  size_t first = ringCap - pos;
+  if (first > len) first = len;
+  memcpy(ring + pos, src, first);
+  if (len > first) memcpy(ring, src + first, len - first);
+}
+
+static void ringRead(size_t pos, uint8_t *dst, size_t len) {
+  size_t first = ringCap - pos;
+  if (first > len) first = len;
+  memcpy(dst, ring + pos, first);
+  if (len > first) memcpy(dst + first, ring, len - first);
+}
+
+// Évince les enregistrements les plus anciens jusqu'à libérer needed octets.
+static void evictFor(size_t needed) {
+  while (ringCap - used < needed && used > 0) {
+    FrecHeader hdr;
+    ringRead(tail, (uint8_t *)&hdr, sizeof(hdr));
+    size_t recLen = sizeof(hdr) + hdr.len;
+    tail = (tail + recLen) % ringCap;
+    used -= recLen;
+  }
+}
+
+void flightRecEvent(uint8_t type, const uint8_t *payload, size_t len) {
+  if (!ring || frozen) return;
+  if (len > 0xFFFF || sizeof(FrecHeader) + len > ringCap) return;
+
+  FrecHeader hdr;
+  hdr.magic = FREC_MAGIC;
+  hdr.type = type;
+  hdr.len = (uint16_t)len;
+  hdr.timestampUs = esp_timer_get_time();
+
+  xSemaphoreTake(recMutex, portMAX_DELAY);
+  // La tâche de dump peut avoir figé entre le test et la prise du mutex.
+  if (!frozen) {
+    evictFor(sizeof(hdr) + len);
+    ringWrite(head, (const uint8_t *)&hdr, sizeof(hdr));
+    if (len) ringWrite((head + sizeof(hdr)) % ringCap, payload, len);
+    head = (head + sizeof(hdr) + len) % ringCap;
+    used += sizeof(hdr) + len;
+  }
+  xSemaphoreGive(recMutex);
+}
+
+void flightRecFreeze() {
+  xSemaphoreTake(recMutex, portMAX_DELAY);
+  frozen = true;
+  xSemaphoreGive(recMutex);
+  logPrintln("Enregistreur de vol figé");
+}
+
+void flightRecResume() {
+  frozen = false;
+  logPrintln("Enregistreur de vol repris");
+}
+
+size_t flightRecSize() {
+  return used;
+}
+
+size_t flightRecRead(size_t offset, uint8_t *buf, size_t maxLen) {
+  if (!ring || offset >= used) return 0;
+  size_t n = used - offset;
+  if (n > maxLen) n = maxLen;
+  ringRead((tail + offset) % ringCap, buf, n);
+  return n;
+}
+
+// Échantillonne les images à cadence fixe : copier chaque capture doublerait
+// le trafic PSRAM en permanence, quelques images par seconde suffisent pour
+// rejouer un incident.
+static void frecTask(void *arg) {
+  CameraFrame frame;
+  uint32_t lastSeq = 0;
+
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(FLIGHT_REC_FRAME_PERIOD_MS));
+    if (frozen) continue;
+    if (!cameraFrameAcquire(&frame, lastSeq, 0)) continue;
+    lastSeq = frame.seq;
+    flightRecEvent(FREC_FRAME, frame.data, frame.len);
+    cameraFrameRelease(&frame);
+  }
+}
+
+void flightRecSetup() {
+  ring = (uint8_t *)heap_caps_malloc(FLIGHT_REC_SIZE, MALLOC_CAP_SPIRAM);
+  if (!ring) {
+    logPrintln("Enregistreur de vol: allocation PSRAM impossible");
+    return;
+  }
+  ringCap = FLIGHT_REC_SIZE;
+  recMutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(frecTask, "flightrec", TASK_STACK_FLIGHTREC, NULL,
+                          TASK_PRIO_FLIGHTREC, NULL, CORE_CONTROL);
+  logPrintf("Enregistreur de vol démarré (%u Ko)", (unsigned)(ringCap / 1024));
+}
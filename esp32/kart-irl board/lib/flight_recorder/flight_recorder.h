@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Enregistreur de vol en PSRAM : anneau d'octets append-only contenant les
+// dernières secondes d'images JPEG (copies du chemin de capture partagé)
+// entrelacées avec les événements de contrôle horodatés. Quand un kart
+// glisse, gèle ou brownout en piste, les preuves sont encore là : on fige
+// l'anneau et on le récupère d'un bloc via GET /flightrec.
+//
+// Format du dump : suite d'enregistrements, du plus ancien au plus récent,
+//   [u8 magic 0x5A][u8 type][u16 len LE][i64 timestampUs LE][payload len octets]
+// Pendant la course : aucune allocation, aucune I/O flash — uniquement des
+// memcpy dans l'anneau pré-alloué.
+
+#define FREC_FRAME   0x01  // payload = image JPEG complète
+#define FREC_COMMAND 0x02  // payload = trame de contrôle binaire brute
+#define FREC_MOTOR   0x03  // payload = i16 vitesse cible
+#define FREC_WIFI    0x04  // payload = u8 id d'événement WiFi
+
+// Alloue l'anneau et démarre la tâche d'échantillonnage des images.
+void flightRecSetup();
+
+// Ajoute un enregistrement horodaté ; silencieux si figé ou trop gros.
+void flightRecEvent(uint8_t type, const uint8_t *payload, size_t len);
+
+// Fige / reprend l'enregistrement (le dump fige pendant sa lecture).
+void flightRecFreeze();
+void flightRecResume();
+
+// Lecture linéarisée du contenu, du plus ancien au plus récent.
+// À n'utiliser que figé : retourne le nombre d'octets copiés, 0 à la fin.
+size_t flightRecSize();
+size_t flightRecRead(size_t offset, uint8_t *buf, size_t maxLen);
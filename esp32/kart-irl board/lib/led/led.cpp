@@ -1,25 +1,56 @@
 #include "led.h"
 
+#include <esp_timer.h>
+
 static int ledPin;
 
+// Moteur de motifs : un esp_timer périodique bascule la LED, le reste du
+// firmware ne bloque jamais. flash(3, 1000) au boot coûtait six secondes
+// de delay(), il coûte maintenant un armement de timer.
+static esp_timer_handle_t patternTimer;
+static volatile int remainingToggles = 0;
+static bool patternLevel = false;
+
+static void onPatternTick(void *arg) {
+  if (remainingToggles <= 0) {
+    esp_timer_stop(patternTimer);
+    digitalWrite(ledPin, LOW);
+    return;
+  }
+  patternLevel = !patternLevel;
+  digitalWrite(ledPin, patternLevel ? HIGH : LOW);
+  remainingToggles--;
+}
+
+static void patternCancel() {
+  if (patternTimer) esp_timer_stop(patternTimer);
+  remainingToggles = 0;
+}
+
 void ledSetup(int pin) {
   ledPin = pin;
   pinMode(ledPin, OUTPUT);
+
+  esp_timer_create_args_t args = {};
+  args.callback = onPatternTick;
+  args.name = "led_pattern";
+  esp_timer_create(&args, &patternTimer);
 }
 
 void ledOn() {
+  patternCancel();
   digitalWrite(ledPin, HIGH);
 }
 
 void ledOff() {
+  patternCancel();
   digitalWrite(ledPin, LOW);
 }
 
 void flash(int number, int delayMs) {
-  for (int i = 0; i < number; i++) {
-    ledOn();
-    delay(delayMs);
-    ledOff();
-    delay(delayMs);
-  }
+  if (number <= 0 || delayMs <= 0) return;
+  patternCancel();
+  patternLevel = false;
+  remainingToggles = number * 2;
+  esp_timer_start_periodic(patternTimer, (uint64_t)delayMs * 1000);
 }
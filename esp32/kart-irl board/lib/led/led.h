@@ -3,6 +3,9 @@
 #include <Arduino.h>
 
 void ledSetup(int pin);
+// ledOn/ledOff annulent le motif en cours.
 void ledOn();
 void ledOff();
+// Asynchrone : programme le clignotement sur esp_timer et rend la main
+// aussitôt, aucun delay() bloquant.
 void flash(int number, int delayMs);
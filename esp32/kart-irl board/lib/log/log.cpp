@@ -1,39 +1,171 @@
 #include "log.h"
 
+#include <stdarg.h>
+
+#include "config.h"
+
 static WiFiServer telnetServer(23);
-static WiFiClient telnetClient;
+
+// --- Clients telnet ---
+//
+// Plusieurs clients simultanés, chacun derrière son propre tampon sortant
+// à taille fixe drainé de façon opportuniste (availableForWrite). Un
+// client dont la fenêtre TCP se ferme (portable refermé aux stands) perd
+// des octets de log, il ne bloque jamais l'écrivain ni les autres clients.
+// Les emplacements appartiennent exclusivement à logFlushTask (accueil,
+// enfilage, drainage) : réassigner slot->client depuis une autre tâche
+// pendant un drain serait une course sur le WiFiClient partagé.
+
+typedef struct {
+  WiFiClient client;
+  uint8_t buf[LOG_TELNET_BUF_SIZE];
+  uint32_t head;  // octets écrits dans le tampon
+  uint32_t tail;  // octets envoyés au client
+  uint32_t droppedBytes;
+} TelnetSlot;
+
+static TelnetSlot telnetSlots[LOG_TELNET_MAX_CLIENTS];
+
+static void telnetEnqueue(const char *data, size_t len) {
+  for (int i = 0; i < LOG_TELNET_MAX_CLIENTS; i++) {
+    TelnetSlot *slot = &telnetSlots[i];
+    if (!slot->client || !slot->client.connected()) continue;
+    size_t space = LOG_TELNET_BUF_SIZE - (slot->head - slot->tail);
+    if (len > space) {
+      slot->droppedBytes += len;
+      continue;  // tampon plein : on jette pour ce client, jamais de blocage
+    }
+    for (size_t b = 0; b < len; b++) {
+      slot->buf[slot->head % LOG_TELNET_BUF_SIZE] = data[b];
+      slot->head++;
+    }
+  }
+}
+
+static volatile bool telnetReady = false;
+
+static void telnetAccept() {
+  if (!telnetReady || !telnetServer.hasClient()) return;
+
+  for (int i = 0; i < LOG_TELNET_MAX_CLIENTS; i++) {
+    TelnetSlot *slot = &telnetSlots[i];
+    if (slot->client && slot->client.connected()) continue;
+    if (slot->client) slot->client.stop();
+    slot->client = telnetServer.available();
+    slot->head = slot->tail = 0;
+    slot->droppedBytes = 0;
+    logPrintln("Nouveau client Telnet connecté");
+    return;
+  }
+  // Tous les emplacements occupés : on refuse le client surnuméraire.
+  telnetServer.available().stop();
+}
+
+static void telnetDrain() {
+  for (int i = 0; i < LOG_TELNET_MAX_CLIENTS; i++) {
+    TelnetSlot *slot = &telnetSlots[i];
+    if (!slot->client || !slot->client.connected()) continue;
+    uint32_t pending = slot->head - slot->tail;
+    if (pending == 0) continue;
+
+    int canWrite = slot->client.availableForWrite();
+    if (canWrite <= 0) continue;
+    if ((uint32_t)canWrite < pending) pending = canWrite;
+
+    while (pending > 0) {
+      uint32_t offset = slot->tail % LOG_TELNET_BUF_SIZE;
+      uint32_t chunk = LOG_TELNET_BUF_SIZE - offset;
+      if (chunk > pending) chunk = pending;
+      size_t written = slot->client.write(slot->buf + offset, chunk);
+      slot->tail += written;
+      pending -= written;
+      if (written < chunk) break;
+    }
+  }
+}
+
+// --- Anneau de messages ---
+//
+// Les appels chauds (commandes, moteur) ne font qu'un formatage + une
+// copie sous section critique courte, jamais d'écriture Serial/TCP.
+// La tâche logFlushTask draine vers Serial et les tampons telnet.
+
+static char ring[LOG_RING_SLOTS][LOG_SLOT_SIZE];
+static volatile uint32_t ringHead = 0;  // prochain emplacement à écrire
+static volatile uint32_t ringTail = 0;  // prochain emplacement à drainer
+static volatile uint32_t dropped = 0;
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void enqueue(const char *message, size_t len, bool newline) {
+  if (len > LOG_SLOT_SIZE - 2) len = LOG_SLOT_SIZE - 2;
+
+  portENTER_CRITICAL(&ringMux);
+  if (ringHead - ringTail >= LOG_RING_SLOTS) {
+    dropped++;
+    portEXIT_CRITICAL(&ringMux);
+    return;
+  }
+  char *slot = ring[ringHead % LOG_RING_SLOTS];
+  memcpy(slot, message, len);
+  if (newline) slot[len++] = '\n';
+  slot[len] = 0;
+  ringHead++;
+  portEXIT_CRITICAL(&ringMux);
+}
+
+static void logFlushTask(void *arg) {
+  uint32_t reportedDrops = 0;
+  while (true) {
+    while (ringTail != ringHead) {
+      const char *slot = ring[ringTail % LOG_RING_SLOTS];
+      Serial.print(slot);
+      telnetEnqueue(slot, strlen(slot));
+      portENTER_CRITICAL(&ringMux);
+      ringTail++;
+      portEXIT_CRITICAL(&ringMux);
+    }
+    telnetAccept();
+    telnetDrain();
+    if (dropped != reportedDrops) {
+      reportedDrops = dropped;
+      Serial.printf("log: %u messages perdus (anneau plein)\n", reportedDrops);
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
 
 void logSetup() {
   Serial.begin(115200);
+  xTaskCreatePinnedToCore(logFlushTask, "logflush", TASK_STACK_LOG, NULL,
+                          TASK_PRIO_LOG, NULL, CORE_CONTROL);
 }
 
 void logStartTelnet() {
   telnetServer.begin();
   telnetServer.setNoDelay(true);
+  telnetReady = true;
   logPrintln("Serveur Telnet démarré sur le port 23");
 }
 
-void logLoop() {
-  if (telnetServer.hasClient()) {
-    if (!telnetClient || !telnetClient.connected()) {
-      if (telnetClient) telnetClient.stop();
-      telnetClient = telnetServer.available();
-      telnetClient.flush();
-      logPrintln("Nouveau client Telnet connecté");
-    }
-  }
-}
-
 void logPrint(String message) {
-  Serial.print(message);
-  if (telnetClient && telnetClient.connected()) {
-    telnetClient.print(message);
-  }
+  enqueue(message.c_str(), message.length(), false);
 }
 
 void logPrintln(String message) {
-  Serial.println(message);
-  if (telnetClient && telnetClient.connected()) {
-    telnetClient.println(message);
-  }
+  enqueue(message.c_str(), message.length(), true);
+}
+
+void logPrintf(const char *fmt, ...) {
+  char buf[LOG_SLOT_SIZE];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len < 0) return;
+  if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+  enqueue(buf, len, true);
+}
+
+uint32_t logDroppedCount() {
+  return dropped;
 }
@@ -5,6 +5,12 @@
 
 void logSetup();
 void logStartTelnet();
-void logLoop();
+
+// Dépose le message dans un anneau en mémoire et rend la main aussitôt ;
+// une tâche de fond basse priorité écrit vers Serial et telnet.
 void logPrint(String message);
 void logPrintln(String message);
+void logPrintf(const char *fmt, ...);
+
+// Nombre de messages perdus faute de place dans l'anneau.
+uint32_t logDroppedCount();
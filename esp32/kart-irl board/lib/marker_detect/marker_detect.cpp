@@ -0,0 +1,154 @@
+#include "marker_detect.h"
+
+#include <esp_camera.h>
+#include <img_converters.h>
+#include <Arduino.h>
+
+#include "config.h"
+#include "camera.h"
+#include "web_server.h"
+#include "log.h"
+
+// Pré-détection embarquée de marqueurs : plutôt que d'attendre que le
+// serveur détecte sur le flux MJPEG (un aller-retour réseau complet), on
+// décode la dernière image partagée au 1/8 (décodage DC, bon marché), on
+// seuille le luma en virgule fixe et on cherche des taches sombres
+// compactes. Les candidats partent en petit événement binaire sur le
+// WebSocket : même un détecteur grossier fait gagner un aller-retour.
+//
+// Pas de capture grayscale dédiée : reconfigurer le capteur en cours de
+// route coûte des centaines de ms et gèlerait le stream.
+
+#define DETECT_MAX_W 80   // VGA / 8
+#define DETECT_MAX_H 60
+#define MAX_BLOBS 8
+#define MARKER_EVENT_OPCODE 0xA0
+
+typedef struct {
+  int minX, minY, maxX, maxY;
+  int pixels;
+} Blob;
+
+static uint8_t *rgbBuf;   // RGB565 décodé, PSRAM
+static uint8_t luma[DETECT_MAX_W * DETECT_MAX_H];
+
+// Dimensions de l'image décodée au 1/8 selon la résolution courante.
+static bool detectDims(int *w, int *h) {
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s) return false;
+  switch (s->status.framesize) {
+    case FRAMESIZE_VGA:  *w = 80; *h = 60; return true;
+    case FRAMESIZE_QVGA: *w = 40; *h = 30; return true;
+    default: return false;
+  }
+}
+
+static void toLuma(const uint8_t *rgb565, int count) {
+  for (int i = 0; i < count; i++) {
+    uint16_t px = (rgb565[2 * i] << 8) | rgb565[2 * i + 1];
+    int r = (px >> 8) & 0xF8;
+    int g = (px >> 3) & 0xFC;
+    int b = (px << 3) & 0xF8;
+    luma[i] = (uint8_t)((r * 77 + g * 150 + b * 29) >> 8);
+  }
+}
+
+// Regroupement grossier : chaque série de pixels sombres d'une ligne est
+// fusionnée au premier blob adjacent (recouvrement horizontal, ligne
+// précédente), sinon ouvre un nouveau blob. Suffisant pour des marqueurs
+// compacts vus de face.
+static int findBlobs(int w, int h, Blob *blobs) {
+  int count = 0;
+  for (int y = 0; y < h; y++) {
+    int x = 0;
+    while (x < w) {
+      if (luma[y * w + x] >= MARKER_THRESHOLD) { x++; continue; }
+      int runStart = x;
+      while (x < w && luma[y * w + x] < MARKER_THRESHOLD) x++;
+      int runEnd = x - 1;
+
+      int target = -1;
+      for (int b = 0; b < count; b++) {
+        if (blobs[b].maxY >= y - 1 && runStart <= blobs[b].maxX + 1 &&
+            runEnd >= blobs[b].minX - 1) {
+          target = b;
+          break;
+        }
+      }
+      if (target < 0) {
+        if (count >= MAX_BLOBS) continue;
+        target = count++;
+        blobs[target].minX = runStart;
+        blobs[target].maxX = runEnd;
+        blobs[target].minY = y;
+        blobs[target].maxY = y;
+        blobs[target].pixels = 0;
+      }
+      Blob *bl = &blobs[target];
+      if (runStart < bl->minX) bl->minX = runStart;
+      if (runEnd > bl->maxX) bl->maxX = runEnd;
+      if (y > bl->maxY) bl->maxY = y;
+      bl->pixels += runEnd - runStart + 1;
+    }
+  }
+  return count;
+}
+
+static void detectTask(void *arg) {
+  CameraFrame frame;
+  uint32_t lastSeq = 0;
+  uint8_t event[3 + MAX_BLOBS * 5];
+  uint8_t eventSeq = 0;
+
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(MARKER_DETECT_PERIOD_MS));
+
+    int w, h;
+    if (!detectDims(&w, &h)) continue;
+    if (!cameraFrameAcquire(&frame, lastSeq, 0)) continue;
+    lastSeq = frame.seq;
+
+    bool decoded = jpg2rgb565(frame.data, frame.len, rgbBuf, JPG_SCALE_8X);
+    cameraFrameRelease(&frame);
+    if (!decoded) continue;
+
+    toLuma(rgbBuf, w * h);
+
+    Blob blobs[MAX_BLOBS];
+    int count = findBlobs(w, h, blobs);
+
+    // Filtre : assez grand, à peu près carré, assez rempli.
+    int kept = 0;
+    event[0] = MARKER_EVENT_OPCODE;
+    event[1] = eventSeq++;
+    for (int b = 0; b < count && kept < MAX_BLOBS; b++) {
+      int bw = blobs[b].maxX - blobs[b].minX + 1;
+      int bh = blobs[b].maxY - blobs[b].minY + 1;
+      if (bw < 3 || bh < 3) continue;
+      if (bw > 2 * bh || bh > 2 * bw) continue;
+      if (blobs[b].pixels * 2 < bw * bh) continue;
+
+      uint8_t *rec = &event[3 + kept * 5];
+      rec[0] = (uint8_t)b;                              // id de candidat
+      rec[1] = (uint8_t)((blobs[b].minX + blobs[b].maxX) / 2);  // centre x
+      rec[2] = (uint8_t)((blobs[b].minY + blobs[b].maxY) / 2);  // centre y
+      rec[3] = (uint8_t)bw;
+      rec[4] = (uint8_t)bh;
+      kept++;
+    }
+    if (kept == 0) continue;
+    event[2] = (uint8_t)kept;
+    webServerSendEvent(event, 3 + kept * 5);
+  }
+}
+
+void markerDetectSetup() {
+  rgbBuf = (uint8_t *)heap_caps_malloc(DETECT_MAX_W * DETECT_MAX_H * 2, MALLOC_CAP_SPIRAM);
+  if (!rgbBuf) {
+    logPrintln("Détection: allocation PSRAM impossible");
+    return;
+  }
+  xTaskCreatePinnedToCore(detectTask, "detect", TASK_STACK_DETECT, NULL,
+                          TASK_PRIO_DETECT, NULL, CORE_CONTROL);
+  logPrintln("Pré-détection de marqueurs démarrée");
+}
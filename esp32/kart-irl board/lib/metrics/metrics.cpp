@@ -0,0 +1,48 @@
+#include "metrics.h"
+
+#include <stdio.h>
+
+// 18 seaux : <2 µs, <4, <8, ... <131072, puis tout le reste.
+#define METRICS_BUCKETS 18
+#define CPU_MHZ 240
+
+static uint32_t hist[METRIC_COUNT][METRICS_BUCKETS];
+
+static const char *metricNames[METRIC_COUNT] = {
+  "capture_us",
+  "frame_send_us",
+  "cmd_dispatch_us",
+  "motor_set_us",
+};
+
+void metricsEnd(MetricId id, uint32_t beginCycles) {
+  uint32_t us = (xthal_get_ccount() - beginCycles) / CPU_MHZ;
+  int bucket = 31 - __builtin_clz(us | 1);
+  if (bucket >= METRICS_BUCKETS) bucket = METRICS_BUCKETS - 1;
+  // Incrément non verrouillé : une course peut perdre un échantillon,
+  // sans conséquence pour un histogramme de profiling.
+  hist[id][bucket]++;
+}
+
+// snprintf renvoie la longueur voulue, pas celle écrite : len doit être
+// borné après chaque appel, sinon buf + len sort du tampon et cap - len
+// déborde en size_t dès que le rapport dépasse la capacité.
+static size_t clampLen(size_t len, int n, size_t cap) {
+  if (n > 0) len += (size_t)n;
+  return len < cap ? len : cap - 1;
+}
+
+size_t metricsReport(char *buf, size_t cap) {
+  size_t len = 0;
+  len = clampLen(len, snprintf(buf + len, cap - len,
+                               "# seaux: <2us <4 <8 ... <131072 reste\n"), cap);
+  for (int id = 0; id < METRIC_COUNT; id++) {
+    len = clampLen(len, snprintf(buf + len, cap - len, "%s", metricNames[id]), cap);
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+      len = clampLen(len, snprintf(buf + len, cap - len, " %lu",
+                                   (unsigned long)hist[id][b]), cap);
+    }
+    len = clampLen(len, snprintf(buf + len, cap - len, "\n"), cap);
+  }
+  return len;
+}
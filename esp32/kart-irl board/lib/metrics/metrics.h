@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <xtensa/hal.h>
+
+// Histogrammes de latence des sections chaudes. Enregistrement par
+// compteur de cycles : un metricsBegin/metricsEnd coûte bien moins d'une
+// microseconde, assez bon marché pour rester actif en production.
+// Des histogrammes, pas des moyennes : notre problème, ce sont les p99.
+
+typedef enum {
+  METRIC_CAPTURE = 0,   // esp_camera_fb_get
+  METRIC_FRAME_SEND,    // envoi d'une image du stream
+  METRIC_CMD_DISPATCH,  // décodage + dispatch d'une commande
+  METRIC_MOTOR_SET,     // Motor::setSpeed
+  METRIC_COUNT
+} MetricId;
+
+static inline uint32_t metricsBegin() {
+  return xthal_get_ccount();
+}
+
+// Clôt la mesure ouverte par metricsBegin et range la durée dans le
+// seau (puissances de 2 de µs) correspondant.
+void metricsEnd(MetricId id, uint32_t beginCycles);
+
+// Écrit le rapport texte (une ligne par métrique) dans buf, retourne la
+// longueur. Servi par /metrics sur le serveur port 80.
+size_t metricsReport(char *buf, size_t cap);
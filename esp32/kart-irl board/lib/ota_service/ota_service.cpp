@@ -0,0 +1,52 @@
+#include "ota_service.h"
+
+#include <ArduinoOTA.h>
+
+#include "config.h"
+#include "camera.h"
+#include "engine.h"
+#include "log.h"
+
+// L'OTA sort de la boucle de contrôle : une tâche priorité minimale
+// sonde la socket à cadence lente au lieu d'un handle() par itération.
+// ArduinoOTA n'offre pas d'attente bloquante sur sa socket, le poll à
+// OTA_POLL_PERIOD_MS en priorité basse en est l'équivalent pratique.
+// Pendant une mise à jour réelle, le stream est mis en pause pour que
+// les écritures flash aient le bus ; en mode course, l'OTA est suspendu.
+
+static volatile bool raceMode = false;
+
+static void otaTask(void *arg) {
+  ArduinoOTA.onStart([]() {
+    // La flash et la capture se disputent le bus : stream en pause.
+    engineStop();
+    cameraStreamPause(true);
+    logPrintln("OTA: démarrage, stream en pause");
+  });
+  ArduinoOTA.onEnd([]() {
+    cameraStreamPause(false);
+    logPrintln("OTA: terminé");
+  });
+  ArduinoOTA.onError([](ota_error_t error) {
+    cameraStreamPause(false);
+    logPrintf("OTA: erreur %d", (int)error);
+  });
+
+  while (true) {
+    if (!raceMode) {
+      ArduinoOTA.handle();
+    }
+    vTaskDelay(pdMS_TO_TICKS(OTA_POLL_PERIOD_MS));
+  }
+}
+
+void otaServiceSetup() {
+  xTaskCreatePinnedToCore(otaTask, "ota", TASK_STACK_OTA, NULL,
+                          TASK_PRIO_OTA, NULL, CORE_CONTROL);
+  logPrintln("Service OTA démarré");
+}
+
+void otaServiceSetRaceMode(bool enabled) {
+  raceMode = enabled;
+  logPrintln(enabled ? "Mode course: OTA suspendu" : "Mode course: OTA réactivé");
+}
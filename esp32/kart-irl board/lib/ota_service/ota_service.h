@@ -0,0 +1,6 @@
+#pragma once
+
+void otaServiceSetup();
+
+// Mode course : suspend complètement le service OTA pendant une session.
+void otaServiceSetRaceMode(bool enabled);
@@ -1,18 +1,65 @@
 #include "servo_controller.h"
 
-#include <ESP32Servo.h>
+#include <array>
 
+#include <Arduino.h>
+
+#include "config.h"
 #include "log.h"
 
-static Servo monServo;
+// Pilotage servo en LEDC direct : résolution 16 bits à 50 Hz, soit une
+// granularité d'environ 0,3 µs d'impulsion — contre ~180 pas avec le
+// write() en degrés de la bibliothèque. La tringlerie de direction étant
+// non linéaire, une table de calibration générée à la compilation mappe
+// l'angle commandé sur la largeur d'impulsion : la linéarisation se fait
+// à bord, sans flottant sur le chemin de commande, et le serveur n'a plus
+// à gaspiller un aller-retour de correction.
+
+static const int SERVO_PWM_FREQ = 50;       // Hz
+static const int SERVO_PWM_RESOLUTION = 16; // bits
+static const int SERVO_PERIOD_US = 20000;
+
+// Points de calibration mesurés sur la tringlerie (angle -> µs).
+// Interpolés linéairement entre eux pour remplir la table complète.
+struct CalibPoint { int angle; int pulseUs; };
+static constexpr CalibPoint calibPoints[] = {
+  {   0, 1050 },
+  {  45, 1330 },
+  {  90, 1520 },
+  { 135, 1690 },
+  { 180, 1950 },
+};
+static constexpr int calibCount = sizeof(calibPoints) / sizeof(calibPoints[0]);
+
+static constexpr std::array<uint16_t, 181> makePulseTable() {
+  std::array<uint16_t, 181> table{};
+  for (int angle = 0; angle <= 180; angle++) {
+    int seg = 0;
+    while (seg < calibCount - 2 && calibPoints[seg + 1].angle < angle) seg++;
+    const CalibPoint &a = calibPoints[seg];
+    const CalibPoint &b = calibPoints[seg + 1];
+    table[angle] = (uint16_t)(a.pulseUs + (angle - a.angle) * (b.pulseUs - a.pulseUs)
+                                              / (b.angle - a.angle));
+  }
+  return table;
+}
+static constexpr auto pulseTable = makePulseTable();
 
 void servoSetup(int pin) {
-  monServo.attach(pin);
-  monServo.write(90);
+  ledcSetup(PWM_CHANNEL_SERVO, SERVO_PWM_FREQ, SERVO_PWM_RESOLUTION);
+  ledcAttachPin(pin, PWM_CHANNEL_SERVO);
+  servoSetAngle(SERVO_CENTER_ANGLE);
+}
+
+void servoSetPulseUs(int us) {
+  if (us < SERVO_PULSE_MIN_US) us = SERVO_PULSE_MIN_US;
+  if (us > SERVO_PULSE_MAX_US) us = SERVO_PULSE_MAX_US;
+  uint32_t duty = ((uint32_t)us << SERVO_PWM_RESOLUTION) / SERVO_PERIOD_US;
+  ledcWrite(PWM_CHANNEL_SERVO, duty);
 }
 
 void servoSetAngle(int angle) {
   if (angle < 0) angle = 0;
   if (angle > 180) angle = 180;
-  monServo.write(angle);
+  servoSetPulseUs(pulseTable[angle]);
 }
@@ -1,4 +1,7 @@
 #pragma once
 
 void servoSetup(int pin);
+// Angle 0-180, linéarisé pour la tringlerie via la table de calibration.
 void servoSetAngle(int angle);
+// Largeur d'impulsion brute en µs, sans passer par la calibration.
+void servoSetPulseUs(int us);
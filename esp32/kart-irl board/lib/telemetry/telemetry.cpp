@@ -0,0 +1,65 @@
+#include "telemetry.h"
+
+#include <WiFi.h>
+#include <esp_timer.h>
+
+#include "config.h"
+#include "camera.h"
+#include "control_protocol.h"
+#include "web_server.h"
+#include "log.h"
+
+// Télémétrie binaire : tous les compteurs bon marché regroupés dans un
+// paquet unique diffusé périodiquement sur le WebSocket. Un paquet de
+// ~48 octets toutes les TELEMETRY_PERIOD_MS coûte rien et permet de
+// corréler les à-coups de latence avec l'état radio et mémoire.
+
+#define TELEMETRY_OPCODE 0xB0
+#define TELEMETRY_VERSION 1
+
+typedef struct __attribute__((packed)) {
+  uint8_t opcode;          // TELEMETRY_OPCODE
+  uint8_t version;
+  uint16_t seq;
+  int64_t uptimeUs;
+  uint32_t framesCaptured;
+  uint32_t framesSent;
+  uint32_t framesDropped;
+  uint32_t commands;
+  uint32_t logDropped;
+  uint32_t freeHeap;
+  uint32_t freePsram;
+  int8_t rssi;             // dBm
+  uint8_t reserved[3];
+} TelemetryPacket;
+
+static void telemetryTask(void *arg) {
+  TelemetryPacket pkt = {};
+  pkt.opcode = TELEMETRY_OPCODE;
+  pkt.version = TELEMETRY_VERSION;
+
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(TELEMETRY_PERIOD_MS));
+
+    pkt.seq++;
+    pkt.uptimeUs = esp_timer_get_time();
+    uint32_t captured, sent, dropped;
+    cameraGetStats(&captured, &sent, &dropped);
+    pkt.framesCaptured = captured;
+    pkt.framesSent = sent;
+    pkt.framesDropped = dropped;
+    pkt.commands = controlCommandCount();
+    pkt.logDropped = logDroppedCount();
+    pkt.freeHeap = ESP.getFreeHeap();
+    pkt.freePsram = ESP.getFreePsram();
+    pkt.rssi = (int8_t)WiFi.RSSI();
+
+    webServerSendEvent((const uint8_t *)&pkt, sizeof(pkt));
+  }
+}
+
+void telemetrySetup() {
+  xTaskCreatePinnedToCore(telemetryTask, "telemetry", TASK_STACK_TELEMETRY, NULL,
+                          TASK_PRIO_TELEMETRY, NULL, CORE_CONTROL);
+  logPrintln("Télémétrie démarrée (" + String(TELEMETRY_PERIOD_MS) + " ms)");
+}
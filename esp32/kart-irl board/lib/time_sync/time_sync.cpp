@@ -0,0 +1,75 @@
+#include "time_sync.h"
+
+#include <esp_timer.h>
+
+// Lissage exponentiel en arithmétique entière : nouveau = ancien + delta/8.
+// Assez réactif pour suivre la dérive des quartz, assez amorti pour ignorer
+// la gigue WiFi d'un échange isolé.
+#define TIMESYNC_FILTER_SHIFT 3
+
+static int64_t offsetFilteredUs = 0;
+static uint32_t rttFilteredUs = 0;
+static bool synced = false;
+
+static uint32_t readU32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t readU64(const uint8_t *p) {
+  return (uint64_t)readU32(p) | ((uint64_t)readU32(p + 4) << 32);
+}
+
+static void writeU32(uint8_t *p, uint32_t v) {
+  p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+static void writeU64(uint8_t *p, uint64_t v) {
+  writeU32(p, (uint32_t)v);
+  writeU32(p + 4, (uint32_t)(v >> 32));
+}
+
+size_t timeSyncBuildResponse(const uint8_t *req, size_t reqLen,
+                             uint8_t *resp, size_t respCap) {
+  if (reqLen < TIMESYNC_REQUEST_LEN || respCap < TIMESYNC_RESPONSE_LEN) return 0;
+
+  int64_t t2 = esp_timer_get_time();
+  uint32_t seq = readU32(req + 1);
+  uint64_t serverTimeUs = readU64(req + 5);
+  uint32_t lastRttUs = readU32(req + 13);
+
+  // Estimation locale : t1 a voyagé environ un demi-RTT avant d'arriver.
+  // Le premier échange (RTT inconnu, 0) initialise le filtre brut.
+  if (lastRttUs > 0 || !synced) {
+    int64_t sample = (int64_t)(serverTimeUs + lastRttUs / 2) - t2;
+    if (!synced) {
+      offsetFilteredUs = sample;
+      rttFilteredUs = lastRttUs;
+      synced = true;
+    } else {
+      offsetFilteredUs += (sample - offsetFilteredUs) >> TIMESYNC_FILTER_SHIFT;
+      rttFilteredUs += ((int32_t)(lastRttUs - rttFilteredUs)) >> TIMESYNC_FILTER_SHIFT;
+    }
+  }
+
+  resp[0] = TIMESYNC_EVENT_OPCODE;
+  writeU32(resp + 1, seq);
+  writeU64(resp + 5, serverTimeUs);
+  writeU64(resp + 13, (uint64_t)t2);
+  // t3 au plus tard possible : juste avant la remise à la pile d'envoi.
+  writeU64(resp + 21, (uint64_t)esp_timer_get_time());
+  return TIMESYNC_RESPONSE_LEN;
+}
+
+int64_t timeSyncOffsetUs() {
+  return offsetFilteredUs;
+}
+
+uint32_t timeSyncRttUs() {
+  return rttFilteredUs;
+}
+
+bool timeSyncIsSynced() {
+  return synced;
+}
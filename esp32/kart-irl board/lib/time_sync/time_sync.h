@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Synchronisation d'horloge kart/serveur sur le canal de contrôle.
+//
+// Les horodatages esp_timer des images (X-Timestamp) ne servent au serveur
+// que rapportés à sa propre horloge. Échange NTP simplifié sur le WebSocket :
+//
+//   requête (serveur -> kart) :
+//     [CTRL_OP_TIMESYNC][u32 seq][u64 t1 serveur, µs][u32 dernier RTT mesuré, µs]
+//   réponse (kart -> serveur) :
+//     [0xD0][u32 seq][u64 t1 écho][u64 t2 réception kart][u64 t3 émission kart]
+//
+// Le serveur calcule RTT et décalage exacts avec t1..t4. Le kart maintient
+// de son côté une estimation filtrée (entiers uniquement, pas de flottant)
+// du décalage horloge-serveur et du RTT, en supposant un aller simple d'un
+// demi-RTT pour dater t1 à sa réception.
+
+#define TIMESYNC_EVENT_OPCODE 0xD0
+#define TIMESYNC_REQUEST_LEN  17
+#define TIMESYNC_RESPONSE_LEN 29
+
+// Construit la réponse dans resp et met à jour l'estimation locale.
+// Retourne la taille écrite, 0 si la requête est malformée.
+size_t timeSyncBuildResponse(const uint8_t *req, size_t reqLen,
+                             uint8_t *resp, size_t respCap);
+
+// Décalage filtré (temps serveur - temps kart, µs) et RTT filtré (µs).
+int64_t timeSyncOffsetUs();
+uint32_t timeSyncRttUs();
+bool timeSyncIsSynced();
@@ -0,0 +1,41 @@
+#include "udp_control.h"
+
+#include <AsyncUDP.h>
+
+#include "config.h"
+#include "control_protocol.h"
+#include "log.h"
+
+// Canal de contrôle UDP : pas de retransmission TCP, donc pas de blocage
+// tête de ligne. Chaque datagramme porte un numéro de séquence uint16
+// little-endian suivi d'une trame de control_protocol.h. Seul le datagramme
+// le plus récent est appliqué, les paquets en retard sont jetés.
+
+static AsyncUDP udp;
+static uint16_t lastSeq = 0;
+static bool seqSeen = false;
+
+static void handleDatagram(AsyncUDPPacket &packet) {
+  const uint8_t *data = packet.data();
+  size_t len = packet.length();
+  if (len < 3) return;
+
+  uint16_t seq = (uint16_t)(data[0] | (data[1] << 8));
+
+  // Comparaison avec repli sur 16 bits : un paquet plus ancien que le
+  // dernier appliqué est jeté, même après dépassement du compteur.
+  if (seqSeen && (int16_t)(seq - lastSeq) <= 0) return;
+  lastSeq = seq;
+  seqSeen = true;
+
+  controlDispatch(data + 2, len - 2);
+}
+
+void udpControlSetup() {
+  if (udp.listen(UDP_CONTROL_PORT)) {
+    udp.onPacket(handleDatagram);
+    logPrintln("Contrôle UDP démarré sur le port " + String(UDP_CONTROL_PORT));
+  } else {
+    logPrintln("Contrôle UDP: échec d'écoute sur le port " + String(UDP_CONTROL_PORT));
+  }
+}
@@ -0,0 +1,86 @@
+#include "udp_stream.h"
+
+#include <AsyncUDP.h>
+#include <esp_timer.h>
+
+#include "config.h"
+#include "camera.h"
+#include "log.h"
+
+// Transport vidéo UDP : les retransmissions TCP font arriver des images
+// périmées en retard, exactement l'inverse de ce qu'il faut pour piloter.
+// Ici chaque JPEG est fragmenté en datagrammes ; une perte coûte une image
+// (66 ms à 15 fps), jamais un gel multi-images. Le flux HTTP de camera.cpp
+// reste disponible pour les navigateurs.
+//
+// Enregistrement du récepteur : n'importe quel datagramme envoyé sur
+// UDP_STREAM_PORT sert de hello et doit être répété avant
+// UDP_STREAM_HELLO_TIMEOUT_MS pour garder le flux.
+//
+// Fragment : [u32 seq image][u16 index][u16 total] + charge utile,
+// little-endian. Le serveur jette l'image entière s'il manque un fragment.
+
+#define FRAG_HEADER_SIZE 8
+
+static AsyncUDP udp;
+static IPAddress receiverIp;
+static uint16_t receiverPort = 0;
+static volatile int64_t lastHelloUs = 0;
+
+static void onHello(AsyncUDPPacket &packet) {
+  receiverIp = packet.remoteIP();
+  receiverPort = packet.remotePort();
+  lastHelloUs = esp_timer_get_time();
+}
+
+static void sendFrame(const CameraFrame *frame) {
+  uint8_t buf[FRAG_HEADER_SIZE + UDP_STREAM_MTU];
+  uint16_t total = (frame->len + UDP_STREAM_MTU - 1) / UDP_STREAM_MTU;
+
+  for (uint16_t idx = 0; idx < total; idx++) {
+    size_t offset = (size_t)idx * UDP_STREAM_MTU;
+    size_t chunk = frame->len - offset;
+    if (chunk > UDP_STREAM_MTU) chunk = UDP_STREAM_MTU;
+
+    buf[0] = frame->seq & 0xFF;
+    buf[1] = (frame->seq >> 8) & 0xFF;
+    buf[2] = (frame->seq >> 16) & 0xFF;
+    buf[3] = (frame->seq >> 24) & 0xFF;
+    buf[4] = idx & 0xFF;
+    buf[5] = idx >> 8;
+    buf[6] = total & 0xFF;
+    buf[7] = total >> 8;
+    memcpy(buf + FRAG_HEADER_SIZE, frame->data + offset, chunk);
+
+    udp.writeTo(buf, FRAG_HEADER_SIZE + chunk, receiverIp, receiverPort);
+  }
+}
+
+static void udpStreamTask(void *arg) {
+  CameraFrame frame;
+  uint32_t lastSeq = 0;
+
+  while (true) {
+    if (receiverPort == 0 ||
+        esp_timer_get_time() - lastHelloUs > (int64_t)UDP_STREAM_HELLO_TIMEOUT_MS * 1000) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+    if (!cameraFrameAcquire(&frame, lastSeq, 200)) continue;
+    lastSeq = frame.seq;
+
+    sendFrame(&frame);
+    cameraFrameRelease(&frame);
+  }
+}
+
+void udpStreamSetup() {
+  if (!udp.listen(UDP_STREAM_PORT)) {
+    logPrintln("Stream UDP: échec d'écoute sur le port " + String(UDP_STREAM_PORT));
+    return;
+  }
+  udp.onPacket(onHello);
+  xTaskCreatePinnedToCore(udpStreamTask, "udpstream", TASK_STACK_UDPSTREAM, NULL,
+                          TASK_PRIO_UDPSTREAM, NULL, CORE_VIDEO);
+  logPrintln("Stream UDP démarré sur le port " + String(UDP_STREAM_PORT));
+}
@@ -0,0 +1,66 @@
+#include "control_protocol.h"
+
+#include "led.h"
+#include "servo_controller.h"
+#include "engine.h"
+#include "failsafe.h"
+#include "ota_service.h"
+
+static volatile uint32_t commandCount = 0;
+
+void controlCountCommand() {
+  commandCount++;
+}
+
+uint32_t controlCommandCount() {
+  return commandCount;
+}
+
+// Chemin rapide : aucune allocation, aucun log en cas de succès.
+bool controlDispatch(const uint8_t *data, size_t len) {
+  if (len < 1) return false;
+
+  switch (data[0]) {
+    case CTRL_OP_SERVO:
+      if (len < 2) return false;
+      servoSetAngle(data[1]);
+      failsafeFeed();
+      controlCountCommand();
+      return true;
+
+    case CTRL_OP_ENGINE: {
+      if (len < 3) return false;
+      int16_t speed = (int16_t)(data[1] | (data[2] << 8));
+      engineSetSpeed(speed);
+      failsafeFeed();
+      controlCountCommand();
+      return true;
+    }
+
+    case CTRL_OP_LED:
+      if (len < 2) return false;
+      if (data[1]) ledOn(); else ledOff();
+      controlCountCommand();
+      return true;
+
+    case CTRL_OP_DRIVE: {
+      // Direction + vitesse du même échantillon, appliquées dans le même tick.
+      if (len < 4) return false;
+      int16_t speed = (int16_t)(data[2] | (data[3] << 8));
+      servoSetAngle(data[1]);
+      engineSetSpeed(speed);
+      failsafeFeed();
+      controlCountCommand();
+      return true;
+    }
+
+    case CTRL_OP_RACE_MODE:
+      if (len < 2) return false;
+      otaServiceSetRaceMode(data[1] != 0);
+      controlCountCommand();
+      return true;
+
+    default:
+      return false;
+  }
+}
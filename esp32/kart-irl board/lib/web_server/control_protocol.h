@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Protocole de contrôle binaire : 1 octet d'opcode suivi des opérandes,
+// little-endian, sans padding. Utilisé par les trames WebSocket binaires
+// (le JSON reste disponible en texte pour le debug).
+
+#define CTRL_OP_SERVO  0x01  // uint8 angle (0-180)
+#define CTRL_OP_ENGINE 0x02  // int16 speed (-255..255)
+#define CTRL_OP_LED    0x03  // uint8 state (0 = off, 1 = on)
+#define CTRL_OP_DRIVE  0x04  // uint8 angle + int16 speed : un échantillon joystick complet
+#define CTRL_OP_RACE_MODE 0x05  // uint8 state (1 = course : OTA suspendu)
+#define CTRL_OP_TIMESYNC  0x06  // u32 seq + u64 t1 + u32 rtt : traité dans web_server
+                                // (il faut un canal de réponse, voir time_sync.h)
+
+// Décode et applique une trame de contrôle binaire.
+// Retourne false si l'opcode est inconnu ou la trame trop courte.
+bool controlDispatch(const uint8_t *data, size_t len);
+
+// Compte une commande acceptée (chemins JSON inclus) / lit le compteur.
+void controlCountCommand();
+uint32_t controlCommandCount();
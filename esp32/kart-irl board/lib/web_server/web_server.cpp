@@ -2,20 +2,78 @@
 
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
+#include "camera.h"
+#include "config_store.h"
+#include "control_protocol.h"
+#include "failsafe.h"
 #include "led.h"
+#include "metrics.h"
 #include "servo_controller.h"
 #include "engine.h"
+#include "time_sync.h"
+#include "flight_recorder.h"
 #include "log.h"
 
-extern const char index_html_start[] asm("_binary_data_index_html_start");
-extern const char index_html_end[] asm("_binary_data_index_html_end");
+// Asset gzippé au build (tools/gzip_assets.py) : moins d'octets sur la
+// radio partagée avec la vidéo, et des rechargements en 304 grâce à l'ETag.
+extern const uint8_t index_html_gz_start[] asm("_binary_data_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_data_index_html_gz_end");
 
 static AsyncWebServer server(80);
 static AsyncWebSocket ws("/ws");
+static String indexEtag;
 
-static void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
+// L'émission AsyncWebSocket n'est pas réentrante : les diffusions partent
+// de plusieurs tâches (détection, télémétrie, rappel ESP-NOW sur la tâche
+// WiFi) et les réponses unitaires (timesync, config) de la tâche async_tcp.
+// Ce mutex sérialise tous ces empilements ainsi que le registre de clients.
+// Il ne couvre pas le drain interne de la file à l'ACK, qui tourne sur la
+// tâche async_tcp : cette fenêtre-là reste du ressort des verrous d'AsyncTCP.
+static SemaphoreHandle_t wsSendMutex;
+
+// ETag dérivé du contenu embarqué (FNV-1a), calculé une fois au boot.
+static String computeEtag(const uint8_t *data, size_t len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return "\"" + String(hash, HEX) + "-" + String((unsigned)len, HEX) + "\"";
+}
+
+static void handleWebSocketMessage(AsyncWebSocketClient *client, void *arg,
+                                   uint8_t *data, size_t len) {
   AwsFrameInfo *info = (AwsFrameInfo*)arg;
-  if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+  if (!info->final || info->index != 0 || info->len != len) return;
+
+  // Chemin rapide : trame binaire compacte, zéro allocation.
+  if (info->opcode == WS_BINARY) {
+    if (len < 1) return;
+    // Timesync répond au client émetteur, hors du dispatch commun.
+    // Réponse sous wsSendMutex : elle empile sur la même file de messages
+    // que les diffusions venues des autres tâches.
+    if (data[0] == CTRL_OP_TIMESYNC) {
+      uint8_t resp[TIMESYNC_RESPONSE_LEN];
+      size_t n = timeSyncBuildResponse(data, len, resp, sizeof(resp));
+      if (n && client) {
+        xSemaphoreTake(wsSendMutex, portMAX_DELAY);
+        client->binary((const char *)resp, n);
+        xSemaphoreGive(wsSendMutex);
+      }
+      return;
+    }
+    uint32_t mc = metricsBegin();
+    bool ok = controlDispatch(data, len);
+    metricsEnd(METRIC_CMD_DISPATCH, mc);
+    if (ok) {
+      flightRecEvent(FREC_COMMAND, data, len);
+    } else {
+      logPrintln("WebSocket: trame binaire invalide");
+    }
+    return;
+  }
+
+  // Chemin JSON conservé en secours pour le debug.
+  if (info->opcode == WS_TEXT) {
     data[len] = 0;
 
     JsonDocument doc;
@@ -30,47 +88,241 @@ static void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
     if (strcmp(type, "servo") == 0) {
       int angle = doc["angle"];
       servoSetAngle(angle);
+      failsafeFeed();
+      controlCountCommand();
       logPrintln("WS: servo " + String(angle));
     } else if (strcmp(type, "engine") == 0) {
       int speed = doc["speed"];
       engineSetSpeed(speed);
+      failsafeFeed();
+      controlCountCommand();
       logPrintln("WS: engine " + String(speed));
+    } else if (strcmp(type, "drive") == 0) {
+      int angle = doc["angle"];
+      int speed = doc["speed"];
+      servoSetAngle(angle);
+      engineSetSpeed(speed);
+      failsafeFeed();
+      controlCountCommand();
+      logPrintln("WS: drive " + String(angle) + "/" + String(speed));
     } else if (strcmp(type, "led") == 0) {
       const char* state = doc["state"];
       if (state && strcmp(state, "on") == 0) {
         ledOn();
+        controlCountCommand();
         logPrintln("WS: led on");
       } else if (state && strcmp(state, "off") == 0) {
         ledOff();
+        controlCountCommand();
         logPrintln("WS: led off");
       }
+    } else if (strcmp(type, "config") == 0) {
+      String reply;
+      if (configHandleMessage(doc, reply)) {
+        // Même file de messages que les diffusions : envoi sous wsSendMutex.
+        if (client) {
+          xSemaphoreTake(wsSendMutex, portMAX_DELAY);
+          client->text(reply);
+          xSemaphoreGive(wsSendMutex);
+        }
+      } else {
+        logPrintln("WS: message config invalide");
+      }
     }
   }
 }
 
+// --- Gestion des clients ---
+//
+// Sans borne, un onglet webapp gelé laisse AsyncTCP empiler des buffers
+// jusqu'à épuiser le tas et réinitialiser le kart. Registre à taille fixe :
+// file sortante pleine = trame de diffusion jetée (la suivante est plus
+// fraîche de toute façon), et éviction du client si sa file reste pleine.
+
+typedef struct {
+  uint32_t id;         // 0 = emplacement libre
+  uint16_t fullCount;  // envois consécutifs refusés faute de place
+  bool evict;          // éviction demandée, exécutée par webServerLoop
+} WsClientSlot;
+
+static WsClientSlot clientSlots[WS_MAX_CLIENTS];
+
+static WsClientSlot *slotFor(uint32_t id) {
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (clientSlots[i].id == id) return &clientSlots[i];
+  }
+  return NULL;
+}
+
 static void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                               AwsEventType type, void *arg, uint8_t *data, size_t len) {
   switch (type) {
-    case WS_EVT_CONNECT:
+    case WS_EVT_CONNECT: {
+      xSemaphoreTake(wsSendMutex, portMAX_DELAY);
+      WsClientSlot *slot = slotFor(0);
+      if (slot) {
+        slot->id = client->id();
+        slot->fullCount = 0;
+        slot->evict = false;
+      }
+      xSemaphoreGive(wsSendMutex);
+      if (!slot) {
+        logPrintln("WS: client #" + String(client->id()) + " refusé (max atteint)");
+        client->close();
+        break;
+      }
       logPrintln("WS client connecté #" + String(client->id()));
       break;
-    case WS_EVT_DISCONNECT:
+    }
+    case WS_EVT_DISCONNECT: {
+      xSemaphoreTake(wsSendMutex, portMAX_DELAY);
+      WsClientSlot *slot = slotFor(client->id());
+      if (slot) slot->id = 0;
+      xSemaphoreGive(wsSendMutex);
       logPrintln("WS client déconnecté #" + String(client->id()));
       break;
+    }
     case WS_EVT_DATA:
-      handleWebSocketMessage(arg, data, len);
+      handleWebSocketMessage(client, arg, data, len);
       break;
     default:
       break;
   }
 }
 
+void webServerSendEvent(const uint8_t *data, size_t len) {
+  if (!wsSendMutex) return;  // rien à diffuser avant webServerSetup
+  xSemaphoreTake(wsSendMutex, portMAX_DELAY);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (clientSlots[i].id == 0) continue;
+    AsyncWebSocketClient *client = ws.client(clientSlots[i].id);
+    if (!client || client->status() != WS_CONNECTED) continue;
+
+    if (client->queueIsFull()) {
+      // La trame est jetée pour ce client : la prochaine sera plus fraîche.
+      // L'éviction est seulement marquée ici : close() peut déclencher
+      // WS_EVT_DISCONNECT de façon synchrone, qui reprend wsSendMutex —
+      // fermer sous le mutex serait un auto-interblocage. webServerLoop
+      // exécute la fermeture hors verrou.
+      if (++clientSlots[i].fullCount >= WS_EVICT_QUEUE_FULL) {
+        clientSlots[i].evict = true;
+      }
+      continue;
+    }
+    clientSlots[i].fullCount = 0;
+    client->binary((const char *)data, len);
+  }
+  xSemaphoreGive(wsSendMutex);
+}
+
+void webServerLoop() {
+  // Évictions demandées par webServerSendEvent, exécutées hors verrou :
+  // la déconnexion synchrone reprend wsSendMutex sans risque.
+  uint32_t evictIds[WS_MAX_CLIENTS];
+  int evictCount = 0;
+  xSemaphoreTake(wsSendMutex, portMAX_DELAY);
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (clientSlots[i].id != 0 && clientSlots[i].evict) {
+      evictIds[evictCount++] = clientSlots[i].id;
+      clientSlots[i].evict = false;
+    }
+  }
+  xSemaphoreGive(wsSendMutex);
+  for (int i = 0; i < evictCount; i++) {
+    logPrintln("WS: client #" + String(evictIds[i]) + " évincé (file pleine)");
+    AsyncWebSocketClient *client = ws.client(evictIds[i]);
+    if (client) client->close();
+  }
+
+  static unsigned long lastCleanup = 0;
+  if (millis() - lastCleanup < WS_CLEANUP_PERIOD_MS) return;
+  lastCleanup = millis();
+  ws.cleanupClients(WS_MAX_CLIENTS);
+}
+
 void webServerSetup() {
+  wsSendMutex = xSemaphoreCreateMutex();
   ws.onEvent(onWebSocketEvent);
   server.addHandler(&ws);
 
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send_P(200, "text/html", index_html_start);
+  size_t indexLen = index_html_gz_end - index_html_gz_start;
+  indexEtag = computeEtag(index_html_gz_start, indexLen);
+
+  server.on("/", HTTP_GET, [indexLen](AsyncWebServerRequest *request) {
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value() == indexEtag) {
+      AsyncWebServerResponse *response = request->beginResponse(304);
+      response->addHeader("ETag", indexEtag);
+      request->send(response);
+      return;
+    }
+    AsyncWebServerResponse *response =
+        request->beginResponse_P(200, "text/html", index_html_gz_start, indexLen);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("ETag", indexEtag);
+    request->send(response);
+  });
+
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    static char report[1024];
+    metricsReport(report, sizeof(report));
+    request->send(200, "text/plain", report);
+  });
+
+  // Instantané : dernière image déjà capturée par la tâche partagée, avec
+  // sa séquence et son horodatage. Aucun appel caméra. Servi ici et non sur
+  // le port 81 : streamHandler boucle tant qu'un spectateur est connecté et
+  // monopolise la tâche httpd du stream. L'image est copiée pour ne pas
+  // retenir un emplacement partagé pendant l'envoi asynchrone.
+  server.on("/capture", HTTP_GET, [](AsyncWebServerRequest *request) {
+    CameraFrame frame;
+    if (!cameraFrameAcquire(&frame, 0, 0)) {
+      request->send(503, "text/plain", "no frame");
+      return;
+    }
+    uint8_t *copy = (uint8_t *)heap_caps_malloc(frame.len, MALLOC_CAP_SPIRAM);
+    if (!copy) {
+      cameraFrameRelease(&frame);
+      request->send(500, "text/plain", "no memory");
+      return;
+    }
+    memcpy(copy, frame.data, frame.len);
+    size_t len = frame.len;
+    uint32_t seq = frame.seq;
+    int64_t timestampUs = frame.timestampUs;
+    cameraFrameRelease(&frame);
+
+    AsyncWebServerResponse *response = request->beginResponse(
+        "image/jpeg", len,
+        [copy, len](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          size_t n = len - index;
+          if (n > maxLen) n = maxLen;
+          memcpy(buffer, copy + index, n);
+          return n;
+        });
+    request->onDisconnect([copy]() { free(copy); });
+
+    char seqBuf[16];
+    char tsBuf[24];
+    snprintf(seqBuf, sizeof(seqBuf), "%lu", (unsigned long)seq);
+    snprintf(tsBuf, sizeof(tsBuf), "%lld", (long long)timestampUs);
+    response->addHeader("X-Sequence", seqBuf);
+    response->addHeader("X-Timestamp", tsBuf);
+    request->send(response);
+  });
+
+  // Dump de l'enregistreur de vol : fige l'anneau le temps de la lecture,
+  // reprend à la fin du transfert (ou sur déconnexion du client).
+  server.on("/flightrec", HTTP_GET, [](AsyncWebServerRequest *request) {
+    flightRecFreeze();
+    request->onDisconnect([]() { flightRecResume(); });
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "application/octet-stream",
+        [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return flightRecRead(index, buffer, maxLen);
+        });
+    request->send(response);
   });
 
   server.begin();
@@ -1,3 +1,15 @@
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+
 void webServerSetup();
+
+// Entretien périodique : nettoyage des connexions mortes (à appeler
+// depuis la tâche contrôle).
+void webServerLoop();
+
+// Diffuse une trame binaire aux clients WebSocket dont la file sortante
+// a de la place ; les clients saturés perdent la trame (la suivante est
+// plus fraîche) et finissent évincés s'ils ne se vident jamais.
+void webServerSendEvent(const uint8_t *data, size_t len);
@@ -2,29 +2,68 @@
 
 #include <WiFi.h>
 #include <ArduinoOTA.h>
+#include <esp_wifi.h>
 
+#include "config.h"
+#include "flight_recorder.h"
 #include "led.h"
 #include "log.h"
 
+// Gestion WiFi orientée latence :
+//  - power save coupé : la radio reste à l'écoute, pas de réveil de 100 ms
+//    devant chaque paquet de contrôle entrant ;
+//  - IP statique optionnelle pour sauter le DHCP au boot ;
+//  - reconnexion pilotée par événement, en place — plus de ESP.restart(),
+//    le failsafe garde le kart à l'arrêt pendant la réassociation.
+
+static void onWifiEvent(WiFiEvent_t event) {
+  uint8_t rec = (uint8_t)event;
+  flightRecEvent(FREC_WIFI, &rec, sizeof(rec));
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      logPrintln("WiFi perdu, réassociation...");
+      WiFi.reconnect();
+      break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      logPrintln("WiFi connecté, IP: " + WiFi.localIP().toString());
+      ledOff();
+      flash(3, 1000);
+      break;
+    default:
+      break;
+  }
+}
+
 void wifiSetup(const char* ssid, const char* password) {
   ledOn();
   logPrintln("Connexion au WiFi...");
   WiFi.mode(WIFI_STA);
-  WiFi.begin(ssid, password);
 
-  while (WiFi.waitForConnectResult() != WL_CONNECTED) {
-    logPrintln("Échec de connexion! Redémarrage...");
-    flash(10, 300);
-    delay(5000);
-    ESP.restart();
-  }
+#if WIFI_USE_STATIC_IP
+  IPAddress ip, gateway, subnet;
+  ip.fromString(WIFI_STATIC_IP);
+  gateway.fromString(WIFI_GATEWAY);
+  subnet.fromString(WIFI_SUBNET);
+  WiFi.config(ip, gateway, subnet);
+#endif
+
+  WiFi.onEvent(onWifiEvent);
+  WiFi.setAutoReconnect(false);  // la reconnexion passe par onWifiEvent
+  WiFi.begin(ssid, password);
 
-  logPrintln("WiFi connecté!");
-  logPrint("Adresse IP: ");
-  logPrintln(WiFi.localIP().toString());
+#if WIFI_DISABLE_POWER_SAVE
+  esp_wifi_set_ps(WIFI_PS_NONE);
+#endif
 
-  ledOff();
-  flash(3, 1000);
+  // Première association seulement ; les coupures suivantes sont gérées
+  // par événement sans bloquer ni redémarrer.
+  unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - start < WIFI_CONNECT_TIMEOUT_MS) {
+    delay(100);
+  }
+  if (WiFi.status() != WL_CONNECTED) {
+    logPrintln("WiFi non connecté, le boot continue (reconnexion en fond)");
+  }
 
   // OTA
   ArduinoOTA.setHostname("ESP32-CAM");
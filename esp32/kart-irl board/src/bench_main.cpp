@@ -0,0 +1,104 @@
+// Banc de micro-benchmarks embarqué — cible `pio run -e bench`.
+// Exerce les unités critiques en isolation et sort un format parsable :
+//   bench <nom> ns_op=<n> heap_delta=<octets> iters=<n>
+// pour comparer les chemins chauds avant/après un changement firmware.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_camera.h>
+#include <esp_timer.h>
+
+#include "config.h"
+#include "led.h"
+#include "log.h"
+#include "servo_controller.h"
+#include "engine.h"
+#include "failsafe.h"
+#include "control_protocol.h"
+#include "camera.h"
+
+static Motor motor(PIN_ENGINE_PWM, PIN_ENGINE_IN_1, PIN_ENGINE_IN_2, PWM_CHANNEL_ENGINE);
+
+static uint32_t heapBefore;
+
+static void benchReport(const char *name, uint32_t iters, int64_t totalUs) {
+  int32_t heapDelta = (int32_t)heapBefore - (int32_t)ESP.getFreeHeap();
+  Serial.printf("bench %s ns_op=%lld heap_delta=%ld iters=%lu\n", name,
+                (long long)(totalUs * 1000 / iters), (long)heapDelta,
+                (unsigned long)iters);
+}
+
+#define BENCH(name, iters, body)                      \
+  do {                                                \
+    heapBefore = ESP.getFreeHeap();                   \
+    int64_t benchT0 = esp_timer_get_time();           \
+    for (uint32_t i = 0; i < (iters); i++) { body; }  \
+    benchReport(name, iters, esp_timer_get_time() - benchT0); \
+  } while (0)
+
+static void benchCommandDecode() {
+  // Chemin historique : JSON parsé à chaque commande.
+  static const char jsonMsg[] = "{\"type\":\"drive\",\"angle\":90,\"speed\":120}";
+  BENCH("json_drive_decode", 2000, {
+    JsonDocument doc;
+    if (!deserializeJson(doc, jsonMsg)) {
+      servoSetAngle(doc["angle"]);
+      engineSetSpeed(doc["speed"]);
+    }
+  });
+
+  // Chemin binaire équivalent.
+  static const uint8_t binMsg[] = { CTRL_OP_DRIVE, 90, 120, 0 };
+  BENCH("binary_drive_dispatch", 2000, {
+    controlDispatch(binMsg, sizeof(binMsg));
+  });
+}
+
+static void benchCapture(framesize_t framesize, const char *name) {
+  sensor_t *s = esp_camera_sensor_get();
+  if (!s) return;
+  s->set_framesize(s, framesize);
+  delay(200);  // laisse le capteur se stabiliser
+
+  BENCH(name, 20, {
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (fb) esp_camera_fb_return(fb);
+  });
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("bench start");
+
+  ledSetup(LED_FLASH);
+  logSetup();
+  servoSetup(SERVO_PIN);
+  engineSetup(motor);
+  failsafeSetup();
+  cameraSetup();  // init capteur seulement, pas de tâche de capture
+
+  benchCommandDecode();
+
+  BENCH("log_enqueue", 2000, {
+    logPrintln("bench: message de test");
+  });
+
+  BENCH("motor_set_speed", 10000, {
+    motor.setSpeed((int)(i & 0xFF) - 128);
+  });
+
+  BENCH("servo_set_angle", 10000, {
+    servoSetAngle((int)(i % 181));
+  });
+
+  benchCapture(FRAMESIZE_VGA, "capture_vga");
+  benchCapture(FRAMESIZE_QVGA, "capture_qvga");
+
+  engineStop();
+  Serial.println("bench done");
+}
+
+void loop() {
+  delay(1000);
+}
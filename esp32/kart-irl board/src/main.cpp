@@ -1,29 +1,106 @@
-#include <ArduinoOTA.h>
-
 #include "config.h"
+#include "config_store.h"
 #include "led.h"
 #include "log.h"
 #include "wifi_manager.h"
 #include "servo_controller.h"
 #include "engine.h"
+#include "failsafe.h"
 #include "web_server.h"
+#include "udp_control.h"
+#include "udp_stream.h"
 #include "camera.h"
+#include "marker_detect.h"
+#include "telemetry.h"
+#include "espnow_link.h"
+#include "ota_service.h"
+#include "flight_recorder.h"
 
 Motor motor(PIN_ENGINE_PWM, PIN_ENGINE_IN_1, PIN_ENGINE_IN_2, PWM_CHANNEL_ENGINE);
 
+// Tâche contrôle épinglée sur CORE_CONTROL : entretien WebSocket.
+// Le streaming vidéo (httpd + capture) reste sur CORE_VIDEO, voir camera.cpp,
+// l'OTA vit dans sa propre tâche basse priorité (ota_service) et les logs
+// (accueil telnet compris) dans logFlushTask.
+static void controlTask(void *arg) {
+  while (true) {
+    webServerLoop();
+    vTaskDelay(pdMS_TO_TICKS(1));
+  }
+}
+
+// --- Orchestration du boot ---
+//
+// Après un brownout en course, chaque seconde de boot est du temps mort.
+// L'init caméra et l'association WiFi sont indépendantes et durent chacune
+// plus d'une seconde : elles tournent en parallèle. Servo, moteur et
+// failsafe n'ont aucune dépendance réseau et partent immédiatement.
+// Chaque étape est chronométrée pour voir les régressions.
+
+static SemaphoreHandle_t bootSync;
+
+static void bootStage(const char *name, void (*fn)()) {
+  uint32_t t0 = millis();
+  fn();
+  logPrintf("Boot: %s en %lu ms", name, (unsigned long)(millis() - t0));
+}
+
+static void cameraBootTask(void *arg) {
+  bootStage("camera", cameraSetup);
+  bootStage("stream", cameraStreamSetup);
+  xSemaphoreGive(bootSync);
+  vTaskDelete(NULL);
+}
+
+static void wifiBootTask(void *arg) {
+  uint32_t t0 = millis();
+  // Identifiants surchargés par kart en NVS, défauts de config.h sinon.
+  String ssid = configGetString("wifi_ssid", WIFI_SSID);
+  String password = configGetString("wifi_password", WIFI_PASSWORD);
+  wifiSetup(ssid.c_str(), password.c_str());
+  logPrintf("Boot: wifi en %lu ms", (unsigned long)(millis() - t0));
+  bootStage("espnow", espnowLinkSetup);
+  bootStage("ota", otaServiceSetup);
+  // Telnet et services réseau seulement une fois l'association faite.
+  bootStage("telnet", logStartTelnet);
+  bootStage("web", webServerSetup);
+  bootStage("udp", udpControlSetup);
+  bootStage("udpstream", udpStreamSetup);
+  xSemaphoreGive(bootSync);
+  vTaskDelete(NULL);
+}
+
 void setup() {
+  uint32_t bootStart = millis();
   ledSetup(LED_FLASH);
   logSetup();
-  cameraSetup();
-  wifiSetup(WIFI_SSID, WIFI_PASSWORD);
-  logStartTelnet();
+  configStoreSetup();
+
+  // Chemin de contrôle prêt tout de suite, sans attendre caméra ni réseau.
   servoSetup(SERVO_PIN);
   engineSetup(motor);
-  webServerSetup();
-  cameraStreamSetup();
+  failsafeSetup();
+  logPrintf("Boot: contrôle prêt en %lu ms", (unsigned long)(millis() - bootStart));
+
+  bootSync = xSemaphoreCreateCounting(2, 0);
+  xTaskCreatePinnedToCore(cameraBootTask, "boot_cam", TASK_STACK_STREAM, NULL,
+                          TASK_PRIO_CONTROL, NULL, CORE_VIDEO);
+  xTaskCreatePinnedToCore(wifiBootTask, "boot_wifi", TASK_STACK_CONTROL, NULL,
+                          TASK_PRIO_CONTROL, NULL, CORE_CONTROL);
+  xSemaphoreTake(bootSync, portMAX_DELAY);
+  xSemaphoreTake(bootSync, portMAX_DELAY);
+
+  // Dépendent de la caméra et du WebSocket à la fois.
+  bootStage("detect", markerDetectSetup);
+  bootStage("telemetrie", telemetrySetup);
+  bootStage("flightrec", flightRecSetup);
+
+  xTaskCreatePinnedToCore(controlTask, "control", TASK_STACK_CONTROL, NULL,
+                          TASK_PRIO_CONTROL, NULL, CORE_CONTROL);
+  logPrintf("Boot: total %lu ms", (unsigned long)(millis() - bootStart));
 }
 
 void loop() {
-  ArduinoOTA.handle();
-  logLoop();
+  // Tout tourne dans des tâches dédiées, la loopTask Arduino ne sert plus.
+  vTaskDelete(NULL);
 }
@@ -0,0 +1,15 @@
+# Compresse les assets de data/ avant compilation ; les .gz sont embarqués
+# dans le binaire (board_build.embed_files) et servis avec
+# Content-Encoding: gzip. mtime=0 pour un résultat reproductible.
+Import("env")
+
+import gzip
+import pathlib
+
+data_dir = pathlib.Path(env["PROJECT_DIR"]) / "data"
+for asset in sorted(data_dir.glob("*.html")) + sorted(data_dir.glob("*.js")):
+    out = asset.with_name(asset.name + ".gz")
+    content = gzip.compress(asset.read_bytes(), compresslevel=9, mtime=0)
+    if not out.exists() or out.read_bytes() != content:
+        out.write_bytes(content)
+        print("gzip_assets: %s -> %s (%d octets)" % (asset.name, out.name, len(content)))